@@ -7,9 +7,18 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#if defined(TAGOTIPS_HOST_THREADS) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "tagotips.h"
 #include <string.h>
 
+#ifdef TAGOTIPS_HOST_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 /* =========================================================================
  * Utilities
  * ========================================================================= */
@@ -28,6 +37,36 @@ static int constant_time_compare(const uint8_t *a, const uint8_t *b, size_t len)
   return diff == 0;
 }
 
+/* =========================================================================
+ * Optional statistics (TAGOTIPS_STATS)
+ *
+ * The STATS_* macros compile to nothing in default builds, so the hot
+ * paths carry no instrumentation cost unless it was asked for.
+ * ========================================================================= */
+
+#ifdef TAGOTIPS_STATS
+
+static tagotips_stats_t g_stats;
+
+#define STATS_INC(field)    (g_stats.field += 1)
+#define STATS_ADD(field, n) (g_stats.field += (n))
+
+void tagotips_get_stats(tagotips_stats_t *out) {
+  if (!out) return;
+  *out = g_stats;
+}
+
+void tagotips_reset_stats(void) {
+  memset(&g_stats, 0, sizeof(g_stats));
+}
+
+#else
+
+#define STATS_INC(field)    ((void)0)
+#define STATS_ADD(field, n) ((void)0)
+
+#endif /* TAGOTIPS_STATS */
+
 static void secure_zero(void *ptr, size_t len) {
   volatile uint8_t *p = (volatile uint8_t *)ptr;
   for (size_t i = 0; i < len; i++) {
@@ -35,11 +74,84 @@ static void secure_zero(void *ptr, size_t len) {
   }
 }
 
+/* =========================================================================
+ * Cipher table placement strategy
+ *
+ * The constant tables (AES_SBOX, AES_RCON, SHA256_K) total ~520 bytes.
+ * Where they live is a target-dependent trade-off, selected at compile
+ * time like the cipher backends:
+ *
+ *   -DTAGOTIPS_TABLE_STRATEGY=0   plain const arrays (default)
+ *   -DTAGOTIPS_TABLE_STRATEGY=1   PROGMEM placement on AVR: tables stay
+ *                                 in flash instead of being copied into
+ *                                 SRAM at startup (minimum RAM)
+ *   -DTAGOTIPS_TABLE_STRATEGY=2   generated AES T-table: 1 KB of flash
+ *                                 replaces the per-byte MixColumns math
+ *                                 with word lookups on 32-bit MCUs
+ *                                 (maximum speed; see tools/gen_ttables.c)
+ *
+ * Table reads go through TABLE_U8/TABLE_U32 so the PROGMEM build can
+ * substitute pgm_read_* shims; everywhere else they compile to plain
+ * indexing.
+ * ========================================================================= */
+
+#define TAGOTIPS_TABLES_DEFAULT 0
+#define TAGOTIPS_TABLES_PROGMEM 1
+#define TAGOTIPS_TABLES_TTABLE  2
+
+#ifndef TAGOTIPS_TABLE_STRATEGY
+#define TAGOTIPS_TABLE_STRATEGY TAGOTIPS_TABLES_DEFAULT
+#endif
+
+#if TAGOTIPS_TABLE_STRATEGY == TAGOTIPS_TABLES_PROGMEM
+#ifndef __AVR__
+#error "TAGOTIPS_TABLE_STRATEGY=1 (PROGMEM) requires an AVR target"
+#endif
+#include <avr/pgmspace.h>
+#define TABLE_ATTR PROGMEM
+#define TABLE_U8(arr, i)  pgm_read_byte(&(arr)[i])
+#define TABLE_U32(arr, i) pgm_read_dword(&(arr)[i])
+#else
+#define TABLE_ATTR
+#define TABLE_U8(arr, i)  ((arr)[i])
+#define TABLE_U32(arr, i) ((arr)[i])
+#endif
+
+/* =========================================================================
+ * SHA-256 backend selection
+ *
+ * sha256_transform() is on the connection-setup path (token hashing, HMAC
+ * key derivation), so a faster compression function can be selected at
+ * compile time, mirroring TAGOTIPS_AES_BACKEND:
+ *
+ *   -DTAGOTIPS_SHA256_BACKEND=0   rolled 64-iteration loop (default,
+ *                                 smallest code)
+ *   -DTAGOTIPS_SHA256_BACKEND=1   fully unrolled rounds, no per-round
+ *                                 branch (fastest portable C)
+ *   -DTAGOTIPS_SHA256_BACKEND=2   x86 SHA-NI intrinsics (compile with
+ *                                 -msha -msse4.1)
+ *
+ * An ARMv8 crypto-extension variant can slot into the same switch once
+ * there is a target to validate it on.
+ * ========================================================================= */
+
+#define TAGOTIPS_SHA256_BACKEND_SOFT     0
+#define TAGOTIPS_SHA256_BACKEND_UNROLLED 1
+#define TAGOTIPS_SHA256_BACKEND_SHANI    2
+
+#ifndef TAGOTIPS_SHA256_BACKEND
+#define TAGOTIPS_SHA256_BACKEND TAGOTIPS_SHA256_BACKEND_SOFT
+#endif
+
+#if TAGOTIPS_SHA256_BACKEND == TAGOTIPS_SHA256_BACKEND_SHANI
+#include <immintrin.h>
+#endif
+
 /* =========================================================================
  * SHA-256 (FIPS 180-4)
  * ========================================================================= */
 
-static const uint32_t SHA256_K[64] = {
+static const uint32_t SHA256_K[64] TABLE_ATTR = {
   0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
   0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
   0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
@@ -68,11 +180,9 @@ static const uint32_t SHA256_K[64] = {
 #define SHA256_sigma0(x)    (ROTR32(x,  7) ^ ROTR32(x, 18) ^ SHR32(x,  3))
 #define SHA256_sigma1(x)    (ROTR32(x, 17) ^ ROTR32(x, 19) ^ SHR32(x, 10))
 
-typedef struct {
-  uint32_t state[8];
-  uint8_t  buf[64];
-  uint64_t total;
-} sha256_ctx;
+/* The context layout lives in tagotips.h as tagotips_sha256_ctx so callers
+ * can hash streaming data; internally we keep the short alias. */
+typedef tagotips_sha256_ctx sha256_ctx;
 
 static void sha256_init(sha256_ctx *ctx) {
   ctx->state[0] = 0x6a09e667;
@@ -86,6 +196,123 @@ static void sha256_init(sha256_ctx *ctx) {
   ctx->total = 0;
 }
 
+#if TAGOTIPS_SHA256_BACKEND == TAGOTIPS_SHA256_BACKEND_UNROLLED
+
+/* Fully unrolled compression: rotated register names instead of the
+ * end-of-round shuffle, message schedule in a 16-word ring, and no
+ * `i < 16` branch inside the rounds. */
+
+#define SHA256_LOAD_W(i) \
+  (w[(i) & 15] = ((uint32_t)block[(i) * 4] << 24) \
+               | ((uint32_t)block[(i) * 4 + 1] << 16) \
+               | ((uint32_t)block[(i) * 4 + 2] << 8) \
+               | ((uint32_t)block[(i) * 4 + 3]))
+
+#define SHA256_NEXT_W(i) \
+  (w[(i) & 15] += SHA256_sigma1(w[((i) - 2) & 15]) \
+                + w[((i) - 7) & 15] \
+                + SHA256_sigma0(w[((i) - 15) & 15]))
+
+#define SHA256_ROUND(a, b, c, d, e, f, g, h, i, w_i) do { \
+  uint32_t t1 = (h) + SHA256_SIGMA1(e) + SHA256_CH(e, f, g) + TABLE_U32(SHA256_K, i) + (w_i); \
+  uint32_t t2 = SHA256_SIGMA0(a) + SHA256_MAJ(a, b, c); \
+  (d) += t1; \
+  (h) = t1 + t2; \
+} while (0)
+
+#define SHA256_ROUND8(i, W_OP) do { \
+  SHA256_ROUND(a, b, c, d, e, f, g, h, (i) + 0, W_OP((i) + 0)); \
+  SHA256_ROUND(h, a, b, c, d, e, f, g, (i) + 1, W_OP((i) + 1)); \
+  SHA256_ROUND(g, h, a, b, c, d, e, f, (i) + 2, W_OP((i) + 2)); \
+  SHA256_ROUND(f, g, h, a, b, c, d, e, (i) + 3, W_OP((i) + 3)); \
+  SHA256_ROUND(e, f, g, h, a, b, c, d, (i) + 4, W_OP((i) + 4)); \
+  SHA256_ROUND(d, e, f, g, h, a, b, c, (i) + 5, W_OP((i) + 5)); \
+  SHA256_ROUND(c, d, e, f, g, h, a, b, (i) + 6, W_OP((i) + 6)); \
+  SHA256_ROUND(b, c, d, e, f, g, h, a, (i) + 7, W_OP((i) + 7)); \
+} while (0)
+
+static void sha256_transform(sha256_ctx *ctx, const uint8_t block[64]) {
+  uint32_t w[16];
+  uint32_t a, b, c, d, e, f, g, h;
+
+  a = ctx->state[0]; b = ctx->state[1];
+  c = ctx->state[2]; d = ctx->state[3];
+  e = ctx->state[4]; f = ctx->state[5];
+  g = ctx->state[6]; h = ctx->state[7];
+
+  SHA256_ROUND8(0, SHA256_LOAD_W);
+  SHA256_ROUND8(8, SHA256_LOAD_W);
+  SHA256_ROUND8(16, SHA256_NEXT_W);
+  SHA256_ROUND8(24, SHA256_NEXT_W);
+  SHA256_ROUND8(32, SHA256_NEXT_W);
+  SHA256_ROUND8(40, SHA256_NEXT_W);
+  SHA256_ROUND8(48, SHA256_NEXT_W);
+  SHA256_ROUND8(56, SHA256_NEXT_W);
+
+  ctx->state[0] += a; ctx->state[1] += b;
+  ctx->state[2] += c; ctx->state[3] += d;
+  ctx->state[4] += e; ctx->state[5] += f;
+  ctx->state[6] += g; ctx->state[7] += h;
+}
+
+#elif TAGOTIPS_SHA256_BACKEND == TAGOTIPS_SHA256_BACKEND_SHANI
+
+/* Two rounds per sha256rnds2 instruction; message schedule held in four
+ * 128-bit registers with sha256msg1/sha256msg2 doing the sigma work. */
+static void sha256_transform(sha256_ctx *ctx, const uint8_t block[64]) {
+  const __m128i shuf_mask =
+    _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+
+  /* Load state and rearrange into the ABEF/CDGH layout sha256rnds2 wants */
+  __m128i tmp    = _mm_loadu_si128((const __m128i *)(const void *)&ctx->state[0]);
+  __m128i state1 = _mm_loadu_si128((const __m128i *)(const void *)&ctx->state[4]);
+  tmp    = _mm_shuffle_epi32(tmp, 0xB1);    /* CDAB */
+  state1 = _mm_shuffle_epi32(state1, 0x1B); /* EFGH */
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);    /* ABEF */
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0);         /* CDGH */
+
+  const __m128i abef_save = state0;
+  const __m128i cdgh_save = state1;
+
+  __m128i msgs[4];
+  for (int i = 0; i < 16; i++) {
+    if (i < 4) {
+      msgs[i] = _mm_shuffle_epi8(
+        _mm_loadu_si128((const __m128i *)(const void *)(block + i * 16)),
+        shuf_mask);
+    } else {
+      __m128i m0 = msgs[i & 3];
+      __m128i m1 = msgs[(i + 1) & 3];
+      __m128i m2 = msgs[(i + 2) & 3];
+      __m128i m3 = msgs[(i + 3) & 3];
+      __m128i sched = _mm_add_epi32(_mm_sha256msg1_epu32(m0, m1),
+                                    _mm_alignr_epi8(m3, m2, 4));
+      msgs[i & 3] = _mm_sha256msg2_epu32(sched, m3);
+    }
+
+    __m128i msg = _mm_add_epi32(
+      msgs[i & 3],
+      _mm_loadu_si128((const __m128i *)(const void *)&SHA256_K[i * 4]));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    msg = _mm_shuffle_epi32(msg, 0x0E);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+  }
+
+  state0 = _mm_add_epi32(state0, abef_save);
+  state1 = _mm_add_epi32(state1, cdgh_save);
+
+  /* Back to linear a..h order */
+  tmp    = _mm_shuffle_epi32(state0, 0x1B);  /* FEBA */
+  state1 = _mm_shuffle_epi32(state1, 0xB1);  /* DCHG */
+  state0 = _mm_blend_epi16(tmp, state1, 0xF0);       /* DCBA */
+  state1 = _mm_alignr_epi8(state1, tmp, 8);          /* HGFE */
+
+  _mm_storeu_si128((__m128i *)(void *)&ctx->state[0], state0);
+  _mm_storeu_si128((__m128i *)(void *)&ctx->state[4], state1);
+}
+
+#else /* TAGOTIPS_SHA256_BACKEND_SOFT */
+
 static void sha256_transform(sha256_ctx *ctx, const uint8_t block[64]) {
   uint32_t w[16];
   uint32_t a, b, c, d, e, f, g, h;
@@ -111,7 +338,7 @@ static void sha256_transform(sha256_ctx *ctx, const uint8_t block[64]) {
       w[i & 15] = w_i;
     }
 
-    uint32_t t1 = h + SHA256_SIGMA1(e) + SHA256_CH(e, f, g) + SHA256_K[i] + w_i;
+    uint32_t t1 = h + SHA256_SIGMA1(e) + SHA256_CH(e, f, g) + TABLE_U32(SHA256_K, i) + w_i;
     uint32_t t2 = SHA256_SIGMA0(a) + SHA256_MAJ(a, b, c);
     h = g; g = f; f = e;
     e = d + t1;
@@ -125,6 +352,8 @@ static void sha256_transform(sha256_ctx *ctx, const uint8_t block[64]) {
   ctx->state[6] += g; ctx->state[7] += h;
 }
 
+#endif /* TAGOTIPS_SHA256_BACKEND */
+
 static void sha256_update(sha256_ctx *ctx, const uint8_t *data, size_t len) {
   size_t buffered = (size_t)(ctx->total & 63);
   ctx->total += len;
@@ -192,11 +421,59 @@ static void sha256(const uint8_t *data, size_t len, uint8_t digest[32]) {
   sha256_final(&ctx, digest);
 }
 
+/* Public streaming interface -- thin wrappers over the internal state
+ * machine so firmware can hash chunked payloads with zero extra buffering. */
+
+void tagotips_sha256_init(tagotips_sha256_ctx *ctx) {
+  sha256_init(ctx);
+}
+
+void tagotips_sha256_update(tagotips_sha256_ctx *ctx, const uint8_t *data, size_t len) {
+  sha256_update(ctx, data, len);
+}
+
+void tagotips_sha256_final(tagotips_sha256_ctx *ctx, uint8_t digest[32]) {
+  sha256_final(ctx, digest);
+}
+
+/* =========================================================================
+ * AES-128 backend selection
+ *
+ * The CCM layer only needs a forward block cipher. Gateways and MCUs with
+ * hardware AES can swap the portable software path for an accelerated one
+ * by defining TAGOTIPS_AES_BACKEND at compile time:
+ *
+ *   -DTAGOTIPS_AES_BACKEND=0   portable byte-wise S-box cipher (default)
+ *   -DTAGOTIPS_AES_BACKEND=1   x86 AES-NI intrinsics (compile with -maes)
+ *   -DTAGOTIPS_AES_BACKEND=2   ESP32 hardware AES peripheral (ESP-IDF)
+ *   -DTAGOTIPS_AES_BACKEND=3   bitsliced constant-time cipher, four blocks
+ *                              per invocation in 64-bit registers
+ *
+ * Every backend consumes the same 176-byte schedule buffer produced by
+ * aes128_key_expansion(), so sessions and the seal/open paths are
+ * backend-agnostic.
+ * ========================================================================= */
+
+#define TAGOTIPS_AES_BACKEND_SOFT      0
+#define TAGOTIPS_AES_BACKEND_AESNI     1
+#define TAGOTIPS_AES_BACKEND_ESP32     2
+#define TAGOTIPS_AES_BACKEND_BITSLICED 3
+
+#ifndef TAGOTIPS_AES_BACKEND
+#define TAGOTIPS_AES_BACKEND TAGOTIPS_AES_BACKEND_SOFT
+#endif
+
+#if TAGOTIPS_AES_BACKEND == TAGOTIPS_AES_BACKEND_AESNI
+#include <wmmintrin.h>
+#elif TAGOTIPS_AES_BACKEND == TAGOTIPS_AES_BACKEND_ESP32
+#include "aes/esp_aes.h"
+#endif
+
 /* =========================================================================
  * AES-128 Encrypt (FIPS 197) -- S-box only, forward cipher
  * ========================================================================= */
 
-static const uint8_t AES_SBOX[256] = {
+static const uint8_t AES_SBOX[256] TABLE_ATTR = {
   0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
   0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
   0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
@@ -215,17 +492,26 @@ static const uint8_t AES_SBOX[256] = {
   0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
 };
 
-static const uint8_t AES_RCON[10] = {
+static const uint8_t AES_RCON[10] TABLE_ATTR = {
   0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36
 };
 
+#if TAGOTIPS_AES_BACKEND == TAGOTIPS_AES_BACKEND_SOFT && TAGOTIPS_TABLE_STRATEGY != TAGOTIPS_TABLES_TTABLE
 static uint8_t xtime(uint8_t x) {
   return (uint8_t)((x << 1) ^ (((x >> 7) & 1) * 0x1b));
 }
+#endif
 
 static void aes128_key_expansion(const uint8_t key[16], uint8_t round_keys[176]) {
   memcpy(round_keys, key, 16);
 
+#if TAGOTIPS_AES_BACKEND == TAGOTIPS_AES_BACKEND_ESP32
+  /* The AES peripheral schedules internally from the raw key; only the
+   * first 16 bytes of the buffer are used. */
+  memset(round_keys + 16, 0, 160);
+  return;
+#endif
+
   for (int i = 4; i < 44; i++) {
     uint8_t tmp[4];
     memcpy(tmp, round_keys + (i - 1) * 4, 4);
@@ -238,12 +524,12 @@ static void aes128_key_expansion(const uint8_t key[16], uint8_t round_keys[176])
       tmp[2] = tmp[3];
       tmp[3] = t;
       /* SubWord */
-      tmp[0] = AES_SBOX[tmp[0]];
-      tmp[1] = AES_SBOX[tmp[1]];
-      tmp[2] = AES_SBOX[tmp[2]];
-      tmp[3] = AES_SBOX[tmp[3]];
+      tmp[0] = TABLE_U8(AES_SBOX, tmp[0]);
+      tmp[1] = TABLE_U8(AES_SBOX, tmp[1]);
+      tmp[2] = TABLE_U8(AES_SBOX, tmp[2]);
+      tmp[3] = TABLE_U8(AES_SBOX, tmp[3]);
       /* XOR Rcon */
-      tmp[0] ^= AES_RCON[(i / 4) - 1];
+      tmp[0] ^= TABLE_U8(AES_RCON, (i / 4) - 1);
     }
 
     round_keys[i * 4 + 0] = round_keys[(i - 4) * 4 + 0] ^ tmp[0];
@@ -253,6 +539,309 @@ static void aes128_key_expansion(const uint8_t key[16], uint8_t round_keys[176])
   }
 }
 
+#if TAGOTIPS_AES_BACKEND == TAGOTIPS_AES_BACKEND_AESNI
+
+static void aes128_encrypt_block(const uint8_t round_keys[176], const uint8_t in[16], uint8_t out[16]) {
+  __m128i state = _mm_loadu_si128((const __m128i *)(const void *)in);
+
+  state = _mm_xor_si128(state, _mm_loadu_si128((const __m128i *)(const void *)round_keys));
+  for (int round = 1; round <= 9; round++) {
+    state = _mm_aesenc_si128(state, _mm_loadu_si128((const __m128i *)(const void *)(round_keys + round * 16)));
+  }
+  state = _mm_aesenclast_si128(state, _mm_loadu_si128((const __m128i *)(const void *)(round_keys + 160)));
+
+  _mm_storeu_si128((__m128i *)(void *)out, state);
+}
+
+#elif TAGOTIPS_AES_BACKEND == TAGOTIPS_AES_BACKEND_ESP32
+
+static void aes128_encrypt_block(const uint8_t round_keys[176], const uint8_t in[16], uint8_t out[16]) {
+  esp_aes_context ctx;
+  esp_aes_init(&ctx);
+  esp_aes_setkey(&ctx, round_keys, 128);
+  esp_aes_crypt_ecb(&ctx, ESP_AES_ENCRYPT, in, out);
+  esp_aes_free(&ctx);
+}
+
+#elif TAGOTIPS_AES_BACKEND == TAGOTIPS_AES_BACKEND_BITSLICED
+
+/*
+ * Bitsliced AES-128: four blocks per invocation, constant time by
+ * construction (no data-dependent loads or branches).
+ *
+ * The 64 state bytes (4 blocks x 16 bytes) live in eight uint64_t planes
+ * where bit k of plane b is bit b of byte k. SubBytes becomes GF(2^8)
+ * inversion via x^254 evaluated as an AND/XOR circuit across all 64
+ * bytes at once; ShiftRows and MixColumns are bit permutations and plane
+ * XORs. The schedule is re-packed into plane form once per call, which
+ * amortizes over the blocks in flight -- the CCM CTR loop feeds four
+ * counter blocks at a time, where the throughput win lives. The CBC-MAC
+ * chain is sequential, so it runs the kernel with one active lane:
+ * slower than the table path, but free of its cache-timing leak.
+ *
+ * Key expansion (once per session) still uses the table S-box.
+ */
+
+/* Transpose an 8x8 bit matrix held as eight row bytes (Hacker's Delight 7-3) */
+static uint64_t bs_transpose8(uint64_t x) {
+  uint64_t t;
+  t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+  x = x ^ t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+  x = x ^ t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+  x = x ^ t ^ (t << 28);
+  return x;
+}
+
+/* 64 bytes (four blocks) -> eight bit planes */
+static void bs_pack(const uint8_t in[64], uint64_t q[8]) {
+  for (int b = 0; b < 8; b++) q[b] = 0;
+  for (int g = 0; g < 8; g++) {
+    uint64_t x = 0;
+    for (int m = 0; m < 8; m++) {
+      x |= (uint64_t)in[g * 8 + m] << (8 * m);
+    }
+    x = bs_transpose8(x);
+    for (int b = 0; b < 8; b++) {
+      q[b] |= ((x >> (8 * b)) & 0xff) << (8 * g);
+    }
+  }
+}
+
+/* Eight bit planes -> 64 bytes */
+static void bs_unpack(const uint64_t q[8], uint8_t out[64]) {
+  for (int g = 0; g < 8; g++) {
+    uint64_t x = 0;
+    for (int b = 0; b < 8; b++) {
+      x |= ((q[b] >> (8 * g)) & 0xff) << (8 * b);
+    }
+    x = bs_transpose8(x);
+    for (int m = 0; m < 8; m++) {
+      out[g * 8 + m] = (uint8_t)(x >> (8 * m));
+    }
+  }
+}
+
+/* One 16-byte block replicated into all four lanes (round keys, single block) */
+static void bs_pack_replicated(const uint8_t blk[16], uint64_t q[8]) {
+  for (int b = 0; b < 8; b++) q[b] = 0;
+  for (int g = 0; g < 2; g++) {
+    uint64_t x = 0;
+    for (int m = 0; m < 8; m++) {
+      x |= (uint64_t)blk[g * 8 + m] << (8 * m);
+    }
+    x = bs_transpose8(x);
+    for (int b = 0; b < 8; b++) {
+      q[b] |= ((x >> (8 * b)) & 0xff) << (8 * g);
+    }
+  }
+  for (int b = 0; b < 8; b++) {
+    q[b] *= 0x0001000100010001ULL;
+  }
+}
+
+/* Plane-wise GF(2^8) multiply: schoolbook then reduce by x^8+x^4+x^3+x+1 */
+static void bs_gf_mul(const uint64_t a[8], const uint64_t b[8], uint64_t r[8]) {
+  uint64_t t[15];
+  for (int k = 0; k < 15; k++) t[k] = 0;
+  for (int i = 0; i < 8; i++) {
+    for (int j = 0; j < 8; j++) {
+      t[i + j] ^= a[i] & b[j];
+    }
+  }
+  for (int k = 14; k >= 8; k--) {
+    t[k - 8] ^= t[k];
+    t[k - 7] ^= t[k];
+    t[k - 5] ^= t[k];
+    t[k - 4] ^= t[k];
+  }
+  memcpy(r, t, 8 * sizeof(uint64_t));
+}
+
+/* Plane-wise GF(2^8) squaring is linear: bit i squares to GF_SQ[i] */
+static void bs_gf_square(const uint64_t a[8], uint64_t r[8]) {
+  static const uint8_t GF_SQ[8] = { 0x01, 0x04, 0x10, 0x40, 0x1b, 0x6c, 0xab, 0x9a };
+  uint64_t out[8];
+  for (int j = 0; j < 8; j++) out[j] = 0;
+  for (int i = 0; i < 8; i++) {
+    for (int j = 0; j < 8; j++) {
+      if (GF_SQ[i] & (1u << j)) out[j] ^= a[i];
+    }
+  }
+  memcpy(r, out, sizeof(out));
+}
+
+/* SubBytes: inversion as x^254 (4 multiplies, 7 squarings), then affine */
+static void bs_sub_bytes(uint64_t q[8]) {
+  uint64_t x2[8], x3[8], x12[8], t[8], inv[8];
+
+  bs_gf_square(q, x2);           /* x^2 */
+  bs_gf_mul(x2, q, x3);          /* x^3 */
+  bs_gf_square(x3, t);           /* x^6 */
+  bs_gf_square(t, x12);          /* x^12 */
+  bs_gf_mul(x12, x3, t);         /* x^15 */
+  bs_gf_square(t, t);            /* x^30 */
+  bs_gf_square(t, t);            /* x^60 */
+  bs_gf_square(t, t);            /* x^120 */
+  bs_gf_square(t, t);            /* x^240 */
+  bs_gf_mul(t, x12, t);          /* x^252 */
+  bs_gf_mul(t, x2, inv);         /* x^254 = x^-1 */
+
+  for (int i = 0; i < 8; i++) {
+    q[i] = inv[i] ^ inv[(i + 4) & 7] ^ inv[(i + 5) & 7] ^
+           inv[(i + 6) & 7] ^ inv[(i + 7) & 7];
+  }
+  /* XOR the 0x63 affine constant (bits 0, 1, 5, 6) */
+  q[0] = ~q[0];
+  q[1] = ~q[1];
+  q[5] = ~q[5];
+  q[6] = ~q[6];
+}
+
+/* ShiftRows: the same 16-byte-position permutation in each block lane */
+static void bs_shift_rows(uint64_t q[8]) {
+  for (int b = 0; b < 8; b++) {
+    uint64_t w = q[b], r = 0;
+    for (int i = 0; i < 16; i++) {
+      int row = i & 3, col = i >> 2;
+      int src = (((col + row) & 3) << 2) | row;
+      r |= ((w >> src) & 0x0001000100010001ULL) << i;
+    }
+    q[b] = r;
+  }
+}
+
+/* Rotate bytes within each column: position 4c+r takes byte 4c+((r+1)&3) */
+static void bs_rotate_rows(const uint64_t a[8], uint64_t r[8]) {
+  for (int b = 0; b < 8; b++) {
+    r[b] = ((a[b] >> 1) & 0x7777777777777777ULL) |
+           ((a[b] & 0x1111111111111111ULL) << 3);
+  }
+}
+
+/* Plane-wise xtime: multiply every byte by 2 in GF(2^8) */
+static void bs_xtime(const uint64_t a[8], uint64_t r[8]) {
+  uint64_t a7 = a[7];
+  r[7] = a[6];
+  r[6] = a[5];
+  r[5] = a[4];
+  r[4] = a[3] ^ a7;
+  r[3] = a[2] ^ a7;
+  r[2] = a[1];
+  r[1] = a[0] ^ a7;
+  r[0] = a7;
+}
+
+/* MixColumns: out = 2(a ^ b) ^ b ^ c ^ d with b, c, d the rotated rows */
+static void bs_mix_columns(uint64_t q[8]) {
+  uint64_t r1[8], r2[8], r3[8], t[8];
+  bs_rotate_rows(q, r1);
+  bs_rotate_rows(r1, r2);
+  bs_rotate_rows(r2, r3);
+  for (int b = 0; b < 8; b++) {
+    t[b] = q[b] ^ r1[b];
+  }
+  bs_xtime(t, t);
+  for (int b = 0; b < 8; b++) {
+    q[b] = t[b] ^ r1[b] ^ r2[b] ^ r3[b];
+  }
+}
+
+static void bs_rounds(const uint64_t bs_rk[11][8], uint64_t q[8]) {
+  for (int b = 0; b < 8; b++) q[b] ^= bs_rk[0][b];
+  for (int round = 1; round <= 10; round++) {
+    bs_sub_bytes(q);
+    bs_shift_rows(q);
+    if (round < 10) bs_mix_columns(q);
+    for (int b = 0; b < 8; b++) q[b] ^= bs_rk[round][b];
+  }
+}
+
+static void aes128_encrypt_blocks(const uint8_t round_keys[176], const uint8_t *in, uint8_t *out, size_t nblocks) {
+  uint64_t bs_rk[11][8];
+  for (int round = 0; round < 11; round++) {
+    bs_pack_replicated(round_keys + round * 16, bs_rk[round]);
+  }
+
+  while (nblocks > 0) {
+    size_t batch = nblocks > 4 ? 4 : nblocks;
+    uint8_t buf[64];
+    const uint8_t *src = in;
+    if (batch < 4) {
+      memset(buf, 0, sizeof(buf));
+      memcpy(buf, in, batch * 16);
+      src = buf;
+    }
+
+    uint64_t q[8];
+    bs_pack(src, q);
+    bs_rounds(bs_rk, q);
+    uint8_t obuf[64];
+    bs_unpack(q, obuf);
+    memcpy(out, obuf, batch * 16);
+
+    in += batch * 16;
+    out += batch * 16;
+    nblocks -= batch;
+  }
+}
+
+static void aes128_encrypt_block(const uint8_t round_keys[176], const uint8_t in[16], uint8_t out[16]) {
+  aes128_encrypt_blocks(round_keys, in, out, 1);
+}
+
+#else /* TAGOTIPS_AES_BACKEND_SOFT */
+
+#if TAGOTIPS_TABLE_STRATEGY == TAGOTIPS_TABLES_TTABLE
+
+#include "tagotips_ttables.h"
+
+static uint32_t tt_load_be32(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+/*
+ * T-table cipher: SubBytes, ShiftRows and MixColumns collapse into four
+ * word lookups and XORs per output column. AES_TE0[x] packs
+ * {02,01,01,03}*S(x) big-endian, and the tables for the other three rows
+ * are byte rotations of it, so a single 1 KB table covers the round.
+ * The last round has no MixColumns and falls back to the plain S-box.
+ */
+static void aes128_encrypt_block(const uint8_t round_keys[176], const uint8_t in[16], uint8_t out[16]) {
+  uint32_t s[4], t[4];
+
+  for (int c = 0; c < 4; c++) {
+    s[c] = tt_load_be32(in + c * 4) ^ tt_load_be32(round_keys + c * 4);
+  }
+
+  for (int round = 1; round <= 9; round++) {
+    const uint8_t *rk = round_keys + round * 16;
+    for (int c = 0; c < 4; c++) {
+      t[c] = AES_TE0[s[c] >> 24]
+           ^ ROTR32(AES_TE0[(s[(c + 1) & 3] >> 16) & 0xff], 8)
+           ^ ROTR32(AES_TE0[(s[(c + 2) & 3] >> 8) & 0xff], 16)
+           ^ ROTR32(AES_TE0[s[(c + 3) & 3] & 0xff], 24)
+           ^ tt_load_be32(rk + c * 4);
+    }
+    memcpy(s, t, sizeof(s));
+  }
+
+  for (int c = 0; c < 4; c++) {
+    uint32_t v = ((uint32_t)TABLE_U8(AES_SBOX, s[c] >> 24) << 24)
+               | ((uint32_t)TABLE_U8(AES_SBOX, (s[(c + 1) & 3] >> 16) & 0xff) << 16)
+               | ((uint32_t)TABLE_U8(AES_SBOX, (s[(c + 2) & 3] >> 8) & 0xff) << 8)
+               | (uint32_t)TABLE_U8(AES_SBOX, s[(c + 3) & 3] & 0xff);
+    v ^= tt_load_be32(round_keys + 160 + c * 4);
+    out[c * 4 + 0] = (uint8_t)(v >> 24);
+    out[c * 4 + 1] = (uint8_t)(v >> 16);
+    out[c * 4 + 2] = (uint8_t)(v >> 8);
+    out[c * 4 + 3] = (uint8_t)v;
+  }
+}
+
+#else /* TAGOTIPS_TABLES_DEFAULT / TAGOTIPS_TABLES_PROGMEM */
+
 static void aes128_encrypt_block(const uint8_t round_keys[176], const uint8_t in[16], uint8_t out[16]) {
   uint8_t s[16];
   memcpy(s, in, 16);
@@ -263,7 +852,7 @@ static void aes128_encrypt_block(const uint8_t round_keys[176], const uint8_t in
   for (int round = 1; round <= 10; round++) {
     /* SubBytes */
     for (int i = 0; i < 16; i++) {
-      s[i] = AES_SBOX[s[i]];
+      s[i] = TABLE_U8(AES_SBOX, s[i]);
     }
 
     /* ShiftRows */
@@ -296,20 +885,37 @@ static void aes128_encrypt_block(const uint8_t round_keys[176], const uint8_t in
   memcpy(out, s, 16);
 }
 
+#endif /* TAGOTIPS_TABLE_STRATEGY */
+
+#endif /* TAGOTIPS_AES_BACKEND */
+
+#if TAGOTIPS_AES_BACKEND != TAGOTIPS_AES_BACKEND_BITSLICED
+/*
+ * Encrypt nblocks independent 16-byte blocks. The bitsliced backend
+ * computes four per kernel invocation; everywhere else this is a plain
+ * loop, so multi-block callers cost the same as before.
+ */
+static void aes128_encrypt_blocks(const uint8_t round_keys[176], const uint8_t *in, uint8_t *out, size_t nblocks) {
+  for (size_t i = 0; i < nblocks; i++) {
+    aes128_encrypt_block(round_keys, in + i * 16, out + i * 16);
+  }
+}
+#endif
+
 /* =========================================================================
  * AES-128-CCM (NIST SP 800-38C)
  *
- * Parameters: tag=8B, L=2, nonce=13B, max plaintext=65535B
+ * Parameters: tag=8B or 4B (truncated), L=2, nonce=13B, max plaintext=65535B
  * ========================================================================= */
 
 /*
  * Format B0 block for CBC-MAC.
  * B0 = [flags] [nonce:13B] [plaintext_len:2B BE]
- * flags = 0x59 = Adata(1) | ((t-2)/2)<<3 | (q-1)
- *       = 0x40 | 0x18 | 0x01
+ * flags = Adata(1) | ((t-2)/2)<<3 | (q-1)
+ *       = 0x59 for the 8-byte tag, 0x49 for the truncated 4-byte tag
  */
-static void ccm_format_b0(const uint8_t nonce[13], size_t plaintext_len, uint8_t b0[16]) {
-  b0[0] = 0x59;
+static void ccm_format_b0(const uint8_t nonce[13], size_t plaintext_len, size_t tag_len, uint8_t b0[16]) {
+  b0[0] = (uint8_t)(0x40 | (((tag_len - 2) / 2) << 3) | 0x01);
   memcpy(b0 + 1, nonce, 13);
   b0[14] = (uint8_t)(plaintext_len >> 8);
   b0[15] = (uint8_t)(plaintext_len);
@@ -327,21 +933,20 @@ static void ccm_format_ctr(const uint8_t nonce[13], uint16_t ctr_val, uint8_t ai
 }
 
 /*
- * CBC-MAC over B0, AAD, and plaintext.
- * Returns the 16-byte CBC-MAC value (tag is first 8 bytes).
+ * Initialize the CBC-MAC state: absorb B0 and the AAD blocks.
+ * The plaintext blocks are absorbed by the fused loops below.
  */
-static void ccm_cbc_mac(
+static void ccm_mac_init(
   const uint8_t round_keys[176],
   const uint8_t nonce[13],
   const uint8_t *aad, size_t aad_len,
-  const uint8_t *plaintext, size_t pt_len,
-  uint8_t mac[16]
+  size_t pt_len, size_t tag_len,
+  uint8_t y[16]
 ) {
   uint8_t block[16];
 
   /* B0 */
-  ccm_format_b0(nonce, pt_len, block);
-  uint8_t y[16];
+  ccm_format_b0(nonce, pt_len, tag_len, block);
   aes128_encrypt_block(round_keys, block, y);
 
   /* AAD: [aad_len:2B BE] [aad] [zero-pad to 16B boundary] */
@@ -371,120 +976,146 @@ static void ccm_cbc_mac(
       aad_offset += chunk;
     }
   }
+}
 
-  /* Plaintext in 16-byte blocks (zero-padded) */
-  size_t pt_offset = 0;
-  while (pt_offset < pt_len) {
-    memset(block, 0, 16);
-    size_t chunk = pt_len - pt_offset;
-    if (chunk > 16) chunk = 16;
-    memcpy(block, plaintext + pt_offset, chunk);
-
-    xor_block(y, block, 16);
-    aes128_encrypt_block(round_keys, y, y);
-
-    pt_offset += chunk;
-  }
-
-  memcpy(mac, y, 16);
+/*
+ * Absorb one (zero-padded) plaintext chunk into the CBC-MAC state.
+ */
+static void ccm_mac_absorb(
+  const uint8_t round_keys[176],
+  const uint8_t *data, size_t chunk,
+  uint8_t y[16]
+) {
+  uint8_t block[16];
+  memset(block, 0, 16);
+  memcpy(block, data, chunk);
+  xor_block(y, block, 16);
+  aes128_encrypt_block(round_keys, y, y);
 }
 
 /*
  * AES-128-CCM encrypt.
  * Input:  plaintext (pt_len bytes)
- * Output: ciphertext || tag (pt_len + 8 bytes)
+ * Output: ciphertext || tag (pt_len + tag_len bytes)
+ *
+ * The CBC-MAC and CTR passes are fused: each 16-byte chunk is read once
+ * and both its MAC block and its keystream block are computed before
+ * moving on, so the payload makes a single trip through memory.
  */
 static void aes128_ccm_encrypt(
   const uint8_t round_keys[176],
   const uint8_t nonce[13],
   const uint8_t *aad, size_t aad_len,
   const uint8_t *plaintext, size_t pt_len,
+  size_t tag_len,
   uint8_t *output
 ) {
-  /* Step 1: CBC-MAC */
-  uint8_t mac[16];
-  ccm_cbc_mac(round_keys, nonce, aad, aad_len, plaintext, pt_len, mac);
+  uint8_t y[16], ai[16];
 
-  /* Step 2: CTR encryption */
-  uint8_t ai[16], si[16];
+  /* CBC-MAC over B0 + AAD */
+  ccm_mac_init(round_keys, nonce, aad, aad_len, pt_len, tag_len, y);
 
-  /* Encrypt tag with A0 */
+  /* A0 keystream (encrypts the tag at the end) */
   ccm_format_ctr(nonce, 0, ai);
-  aes128_encrypt_block(round_keys, ai, si);
-  uint8_t encrypted_tag[8];
-  for (int i = 0; i < 8; i++) {
-    encrypted_tag[i] = mac[i] ^ si[i];
-  }
+  uint8_t s0[16];
+  aes128_encrypt_block(round_keys, ai, s0);
 
-  /* Encrypt plaintext with A1, A2, ... */
+  /* Fused loop: keystream fetched up to four counter blocks at a time
+   * (independent, so batch backends run them in parallel lanes), then
+   * MAC block + XOR per chunk */
   size_t offset = 0;
   uint16_t ctr = 1;
   while (offset < pt_len) {
-    ccm_format_ctr(nonce, ctr, ai);
-    aes128_encrypt_block(round_keys, ai, si);
+    size_t stride = (pt_len - offset + 15) / 16;
+    if (stride > 4) stride = 4;
 
-    size_t chunk = pt_len - offset;
-    if (chunk > 16) chunk = 16;
-    for (size_t i = 0; i < chunk; i++) {
-      output[offset + i] = plaintext[offset + i] ^ si[i];
+    uint8_t actr[64], ks[64];
+    for (size_t b = 0; b < stride; b++) {
+      ccm_format_ctr(nonce, (uint16_t)(ctr + b), actr + b * 16);
     }
+    aes128_encrypt_blocks(round_keys, actr, ks, stride);
 
-    offset += chunk;
-    ctr++;
+    for (size_t b = 0; b < stride; b++) {
+      size_t chunk = pt_len - offset;
+      if (chunk > 16) chunk = 16;
+
+      ccm_mac_absorb(round_keys, plaintext + offset, chunk, y);
+      for (size_t i = 0; i < chunk; i++) {
+        output[offset + i] = plaintext[offset + i] ^ ks[b * 16 + i];
+      }
+      offset += chunk;
+    }
+    ctr = (uint16_t)(ctr + stride);
   }
 
   /* Append encrypted tag */
-  memcpy(output + pt_len, encrypted_tag, 8);
+  for (size_t i = 0; i < tag_len; i++) {
+    output[pt_len + i] = y[i] ^ s0[i];
+  }
 }
 
 /*
  * AES-128-CCM decrypt.
- * Input:  ciphertext || tag (ct_len bytes, where ct_len includes 8-byte tag)
- * Output: plaintext (ct_len - 8 bytes)
+ * Input:  ciphertext || tag (ct_len bytes, where ct_len includes the tag)
+ * Output: plaintext (ct_len - tag_len bytes)
  * Returns 0 on success, -1 on authentication failure (plaintext is zeroed).
+ *
+ * Fused like the encrypt path: each chunk is decrypted and immediately
+ * absorbed into the CBC-MAC while still warm.
  */
 static int aes128_ccm_decrypt(
   const uint8_t round_keys[176],
   const uint8_t nonce[13],
   const uint8_t *aad, size_t aad_len,
   const uint8_t *input, size_t input_len,
+  size_t tag_len,
   uint8_t *plaintext
 ) {
-  if (input_len < 8) return -1;
-  size_t pt_len = input_len - 8;
+  if (input_len < tag_len) return -1;
+  size_t pt_len = input_len - tag_len;
 
-  uint8_t ai[16], si[16];
+  uint8_t y[16], ai[16], si[16];
+
+  /* CBC-MAC over B0 + AAD */
+  ccm_mac_init(round_keys, nonce, aad, aad_len, pt_len, tag_len, y);
 
   /* Recover tag: decrypt with A0 */
   ccm_format_ctr(nonce, 0, ai);
   aes128_encrypt_block(round_keys, ai, si);
   uint8_t recovered_tag[8];
-  for (int i = 0; i < 8; i++) {
+  for (size_t i = 0; i < tag_len; i++) {
     recovered_tag[i] = input[pt_len + i] ^ si[i];
   }
 
-  /* CTR decrypt plaintext with A1, A2, ... */
+  /* Fused loop: keystream fetched up to four counter blocks at a time,
+   * then CTR decrypt chunk and MAC the plaintext chunk */
   size_t offset = 0;
   uint16_t ctr = 1;
   while (offset < pt_len) {
-    ccm_format_ctr(nonce, ctr, ai);
-    aes128_encrypt_block(round_keys, ai, si);
+    size_t stride = (pt_len - offset + 15) / 16;
+    if (stride > 4) stride = 4;
 
-    size_t chunk = pt_len - offset;
-    if (chunk > 16) chunk = 16;
-    for (size_t i = 0; i < chunk; i++) {
-      plaintext[offset + i] = input[offset + i] ^ si[i];
+    uint8_t actr[64], ks[64];
+    for (size_t b = 0; b < stride; b++) {
+      ccm_format_ctr(nonce, (uint16_t)(ctr + b), actr + b * 16);
     }
+    aes128_encrypt_blocks(round_keys, actr, ks, stride);
 
-    offset += chunk;
-    ctr++;
-  }
+    for (size_t b = 0; b < stride; b++) {
+      size_t chunk = pt_len - offset;
+      if (chunk > 16) chunk = 16;
+
+      for (size_t i = 0; i < chunk; i++) {
+        plaintext[offset + i] = input[offset + i] ^ ks[b * 16 + i];
+      }
+      ccm_mac_absorb(round_keys, plaintext + offset, chunk, y);
 
-  /* Verify: CBC-MAC over AAD + decrypted plaintext */
-  uint8_t mac[16];
-  ccm_cbc_mac(round_keys, nonce, aad, aad_len, plaintext, pt_len, mac);
+      offset += chunk;
+    }
+    ctr = (uint16_t)(ctr + stride);
+  }
 
-  if (!constant_time_compare(mac, recovered_tag, 8)) {
+  if (!constant_time_compare(y, recovered_tag, tag_len)) {
     secure_zero(plaintext, pt_len);
     return -1;
   }
@@ -504,7 +1135,7 @@ static int aes128_ccm_decrypt(
 #define RESERVED_FLAGS      0x41
 
 static int32_t flags_encode(uint8_t cipher, uint8_t version, uint8_t method, uint8_t *out) {
-  if (cipher > 4) return TAGOTIPS_ERR_UNSUPPORTED_CIPHER;
+  if (cipher > 5) return TAGOTIPS_ERR_UNSUPPORTED_CIPHER;
   if (version > 3) return TAGOTIPS_ERR_UNSUPPORTED_VERSION;
   if (method > 3) return TAGOTIPS_ERR_INVALID_METHOD;
 
@@ -521,7 +1152,7 @@ static int32_t flags_decode(uint8_t byte, uint8_t *cipher, uint8_t *version, uin
   uint8_t v = (byte & FLAGS_VERSION_MASK) >> FLAGS_VERSION_SHIFT;
   uint8_t m = byte & FLAGS_METHOD_MASK;
 
-  if (c > 4) return TAGOTIPS_ERR_UNSUPPORTED_CIPHER;
+  if (c > 5) return TAGOTIPS_ERR_UNSUPPORTED_CIPHER;
   if (m > 3) return TAGOTIPS_ERR_INVALID_METHOD;
 
   *cipher = c;
@@ -590,28 +1221,48 @@ void tagotips_derive_device_hash(const char *serial, uint8_t out[8]) {
   secure_zero(digest, 32);
 }
 
-int32_t tagotips_seal(
+/*
+ * Seal with a pre-expanded key schedule. Shared by the one-shot and
+ * session entry points.
+ */
+/*
+ * Tag length for a cipher code, or 0 for suites this library does not
+ * implement (the GCM / AES-256 / ChaCha20 server-side codes).
+ */
+static size_t cipher_tag_size(uint8_t cipher) {
+  switch (cipher) {
+    case TAGOTIPS_CIPHER_AES128_CCM:   return TAGOTIPS_TAG_SIZE;
+    case TAGOTIPS_CIPHER_AES128_CCM_4: return TAGOTIPS_CCM4_TAG_SIZE;
+    default:                           return 0;
+  }
+}
+
+static int32_t seal_with_schedule(
+  const uint8_t round_keys[176],
   const uint8_t *inner_frame, size_t inner_len,
-  uint8_t method, uint32_t counter,
+  uint8_t cipher, uint8_t method, uint32_t counter,
   const uint8_t auth_hash[8], const uint8_t device_hash[8],
-  const uint8_t key[16],
   uint8_t *out_buf, size_t out_buf_len
 ) {
-  if (!inner_frame || !auth_hash || !device_hash || !key || !out_buf) {
+  if (!inner_frame || !auth_hash || !device_hash || !out_buf) {
     return TAGOTIPS_ERR_NULL_PTR;
   }
   if (inner_len > TAGOTIPS_MAX_INNER_FRAME) {
     return TAGOTIPS_ERR_INNER_TOO_LARGE;
   }
 
-  size_t envelope_len = TAGOTIPS_HEADER_SIZE + inner_len + TAGOTIPS_TAG_SIZE;
+  size_t tag_size = cipher_tag_size(cipher);
+  if (tag_size == 0) return TAGOTIPS_ERR_UNSUPPORTED_CIPHER;
+
+  size_t envelope_len = TAGOTIPS_HEADER_SIZE + inner_len + tag_size;
   if (out_buf_len < envelope_len) {
+    STATS_INC(buffer_too_small);
     return TAGOTIPS_ERR_BUFFER_TOO_SMALL;
   }
 
-  /* Encode flags (cipher=0 AES-128-CCM, version=0) */
+  /* Encode flags (version=0) */
   uint8_t flags;
-  int32_t rc = flags_encode(0, 0, method, &flags);
+  int32_t rc = flags_encode(cipher, 0, method, &flags);
   if (rc != TAGOTIPS_OK) return rc;
 
   /* Build header */
@@ -628,32 +1279,32 @@ int32_t tagotips_seal(
   uint8_t nonce[TAGOTIPS_NONCE_SIZE];
   construct_nonce(flags, device_hash, counter, nonce);
 
-  /* Key expansion */
-  uint8_t round_keys[176];
-  aes128_key_expansion(key, round_keys);
-
   /* Write header to output */
   memcpy(out_buf, aad, TAGOTIPS_HEADER_SIZE);
 
   /* CCM encrypt (writes ciphertext + tag after header) */
   aes128_ccm_encrypt(round_keys, nonce, aad, TAGOTIPS_HEADER_SIZE,
-                     inner_frame, inner_len, out_buf + TAGOTIPS_HEADER_SIZE);
-
-  secure_zero(round_keys, 176);
+                     inner_frame, inner_len, tag_size, out_buf + TAGOTIPS_HEADER_SIZE);
 
+  STATS_INC(frames_sealed);
+  STATS_ADD(bytes_sealed, inner_len);
   return (int32_t)envelope_len;
 }
 
-int32_t tagotips_open(
+/*
+ * Open with a pre-expanded key schedule. Shared by the one-shot and
+ * session entry points.
+ */
+static int32_t open_with_schedule(
+  const uint8_t round_keys[176],
   const uint8_t *envelope, size_t envelope_len,
-  const uint8_t key[16],
   TagotipsHeader *out_header, uint8_t *out_method,
   uint8_t *out_inner, size_t out_inner_len
 ) {
-  if (!envelope || !key || !out_header || !out_method || !out_inner) {
+  if (!envelope || !out_header || !out_method || !out_inner) {
     return TAGOTIPS_ERR_NULL_PTR;
   }
-  if (envelope_len < TAGOTIPS_HEADER_SIZE + TAGOTIPS_TAG_SIZE) {
+  if (envelope_len < TAGOTIPS_HEADER_SIZE + TAGOTIPS_CCM4_TAG_SIZE) {
     return TAGOTIPS_ERR_ENVELOPE_TOO_SHORT;
   }
 
@@ -667,7 +1318,9 @@ int32_t tagotips_open(
   if (rc != TAGOTIPS_OK) return rc;
 
   if (version != 0) return TAGOTIPS_ERR_UNSUPPORTED_VERSION;
-  if (cipher != 0) return TAGOTIPS_ERR_UNSUPPORTED_CIPHER;
+
+  size_t tag_size = cipher_tag_size(cipher);
+  if (tag_size == 0) return TAGOTIPS_ERR_UNSUPPORTED_CIPHER;
 
   *out_method = method;
 
@@ -675,12 +1328,13 @@ int32_t tagotips_open(
   const uint8_t *ct_with_tag = envelope + TAGOTIPS_HEADER_SIZE;
   size_t ct_with_tag_len = envelope_len - TAGOTIPS_HEADER_SIZE;
 
-  if (ct_with_tag_len < TAGOTIPS_TAG_SIZE) {
+  if (ct_with_tag_len < tag_size) {
     return TAGOTIPS_ERR_ENVELOPE_TOO_SHORT;
   }
 
-  size_t pt_len = ct_with_tag_len - TAGOTIPS_TAG_SIZE;
+  size_t pt_len = ct_with_tag_len - tag_size;
   if (out_inner_len < pt_len) {
+    STATS_INC(buffer_too_small);
     return TAGOTIPS_ERR_BUFFER_TOO_SMALL;
   }
 
@@ -688,27 +1342,871 @@ int32_t tagotips_open(
   uint8_t nonce[TAGOTIPS_NONCE_SIZE];
   construct_nonce(out_header->flags, out_header->device_hash, out_header->counter, nonce);
 
-  /* Key expansion */
-  uint8_t round_keys[176];
-  aes128_key_expansion(key, round_keys);
-
   /* AAD is the header bytes */
   const uint8_t *aad = envelope;
 
   /* CCM decrypt */
   int decrypt_ok = aes128_ccm_decrypt(round_keys, nonce, aad, TAGOTIPS_HEADER_SIZE,
-                                      ct_with_tag, ct_with_tag_len, out_inner);
-
-  secure_zero(round_keys, 176);
+                                      ct_with_tag, ct_with_tag_len, tag_size, out_inner);
 
   if (decrypt_ok != 0) {
+    STATS_INC(auth_failures);
     return TAGOTIPS_ERR_DECRYPTION_FAILED;
   }
 
+  STATS_INC(frames_opened);
+  STATS_ADD(bytes_opened, pt_len);
   return (int32_t)pt_len;
 }
 
-int32_t tagotips_parse_header(
+int32_t tagotips_seal(
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  const uint8_t key[16],
+  uint8_t *out_buf, size_t out_buf_len
+) {
+  if (!key) return TAGOTIPS_ERR_NULL_PTR;
+
+  uint8_t round_keys[176];
+  aes128_key_expansion(key, round_keys);
+
+  int32_t rc = seal_with_schedule(round_keys, inner_frame, inner_len,
+                                  TAGOTIPS_CIPHER_AES128_CCM, method, counter,
+                                  auth_hash, device_hash,
+                                  out_buf, out_buf_len);
+
+  secure_zero(round_keys, 176);
+  return rc;
+}
+
+int32_t tagotips_seal_cipher(
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t cipher, uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  const uint8_t key[16],
+  uint8_t *out_buf, size_t out_buf_len
+) {
+  if (!key) return TAGOTIPS_ERR_NULL_PTR;
+
+  uint8_t round_keys[176];
+  aes128_key_expansion(key, round_keys);
+
+  int32_t rc = seal_with_schedule(round_keys, inner_frame, inner_len,
+                                  cipher, method, counter, auth_hash, device_hash,
+                                  out_buf, out_buf_len);
+
+  secure_zero(round_keys, 176);
+  return rc;
+}
+
+int32_t tagotips_open(
+  const uint8_t *envelope, size_t envelope_len,
+  const uint8_t key[16],
+  TagotipsHeader *out_header, uint8_t *out_method,
+  uint8_t *out_inner, size_t out_inner_len
+) {
+  if (!key) return TAGOTIPS_ERR_NULL_PTR;
+
+  uint8_t round_keys[176];
+  aes128_key_expansion(key, round_keys);
+
+  int32_t rc = open_with_schedule(round_keys, envelope, envelope_len,
+                                  out_header, out_method, out_inner, out_inner_len);
+
+  secure_zero(round_keys, 176);
+  return rc;
+}
+
+/* =========================================================================
+ * In-place seal/open -- single buffer, no staging copy
+ *
+ * CTR mode is a stream XOR and the fused CCM loop absorbs each chunk into
+ * the CBC-MAC before overwriting it, so sealing and opening can operate
+ * directly on the envelope buffer. The caller builds the plaintext at
+ * offset TAGOTIPS_HEADER_SIZE and the header/tag are written around it.
+ * ========================================================================= */
+
+int32_t tagotips_seal_inplace(
+  uint8_t *buf, size_t buf_len, size_t inner_len,
+  uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  const uint8_t key[16]
+) {
+  if (!buf || !key) return TAGOTIPS_ERR_NULL_PTR;
+
+  uint8_t round_keys[176];
+  aes128_key_expansion(key, round_keys);
+
+  int32_t rc = seal_with_schedule(round_keys, buf + TAGOTIPS_HEADER_SIZE, inner_len,
+                                  TAGOTIPS_CIPHER_AES128_CCM, method, counter,
+                                  auth_hash, device_hash,
+                                  buf, buf_len);
+
+  secure_zero(round_keys, 176);
+  return rc;
+}
+
+int32_t tagotips_open_inplace(
+  uint8_t *buf, size_t envelope_len,
+  const uint8_t key[16],
+  TagotipsHeader *out_header, uint8_t *out_method
+) {
+  if (!buf || !key) return TAGOTIPS_ERR_NULL_PTR;
+  if (envelope_len < TAGOTIPS_HEADER_SIZE + TAGOTIPS_CCM4_TAG_SIZE) {
+    return TAGOTIPS_ERR_ENVELOPE_TOO_SHORT;
+  }
+
+  uint8_t round_keys[176];
+  aes128_key_expansion(key, round_keys);
+
+  int32_t rc = open_with_schedule(round_keys, buf, envelope_len,
+                                  out_header, out_method,
+                                  buf + TAGOTIPS_HEADER_SIZE,
+                                  envelope_len - TAGOTIPS_HEADER_SIZE);
+
+  secure_zero(round_keys, 176);
+  return rc;
+}
+
+/* =========================================================================
+ * Session API -- cached key schedule across seal/open calls
+ * ========================================================================= */
+
+int32_t tagotips_session_init(tagotips_session_t *session, const uint8_t key[16]) {
+  if (!session || !key) return TAGOTIPS_ERR_NULL_PTR;
+  aes128_key_expansion(key, session->round_keys);
+  return TAGOTIPS_OK;
+}
+
+int32_t tagotips_session_seal(
+  const tagotips_session_t *session,
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  uint8_t *out_buf, size_t out_buf_len
+) {
+  if (!session) return TAGOTIPS_ERR_NULL_PTR;
+  return seal_with_schedule(session->round_keys, inner_frame, inner_len,
+                            TAGOTIPS_CIPHER_AES128_CCM, method, counter,
+                            auth_hash, device_hash,
+                            out_buf, out_buf_len);
+}
+
+int32_t tagotips_session_seal_cipher(
+  const tagotips_session_t *session,
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t cipher, uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  uint8_t *out_buf, size_t out_buf_len
+) {
+  if (!session) return TAGOTIPS_ERR_NULL_PTR;
+  return seal_with_schedule(session->round_keys, inner_frame, inner_len,
+                            cipher, method, counter, auth_hash, device_hash,
+                            out_buf, out_buf_len);
+}
+
+int32_t tagotips_session_open(
+  const tagotips_session_t *session,
+  const uint8_t *envelope, size_t envelope_len,
+  TagotipsHeader *out_header, uint8_t *out_method,
+  uint8_t *out_inner, size_t out_inner_len
+) {
+  if (!session) return TAGOTIPS_ERR_NULL_PTR;
+  return open_with_schedule(session->round_keys, envelope, envelope_len,
+                            out_header, out_method, out_inner, out_inner_len);
+}
+
+int32_t tagotips_session_seal_inplace(
+  const tagotips_session_t *session,
+  uint8_t *buf, size_t buf_len, size_t inner_len,
+  uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8]
+) {
+  if (!session || !buf) return TAGOTIPS_ERR_NULL_PTR;
+  return seal_with_schedule(session->round_keys, buf + TAGOTIPS_HEADER_SIZE, inner_len,
+                            TAGOTIPS_CIPHER_AES128_CCM, method, counter,
+                            auth_hash, device_hash,
+                            buf, buf_len);
+}
+
+int32_t tagotips_session_open_inplace(
+  const tagotips_session_t *session,
+  uint8_t *buf, size_t envelope_len,
+  TagotipsHeader *out_header, uint8_t *out_method
+) {
+  if (!session || !buf) return TAGOTIPS_ERR_NULL_PTR;
+  if (envelope_len < TAGOTIPS_HEADER_SIZE + TAGOTIPS_CCM4_TAG_SIZE) {
+    return TAGOTIPS_ERR_ENVELOPE_TOO_SHORT;
+  }
+  return open_with_schedule(session->round_keys, buf, envelope_len,
+                            out_header, out_method,
+                            buf + TAGOTIPS_HEADER_SIZE,
+                            envelope_len - TAGOTIPS_HEADER_SIZE);
+}
+
+void tagotips_session_destroy(tagotips_session_t *session) {
+  if (!session) return;
+  secure_zero(session->round_keys, sizeof(session->round_keys));
+}
+
+/* =========================================================================
+ * Streaming seal -- incremental plaintext, incremental ciphertext
+ * ========================================================================= */
+
+/*
+ * Encrypt one full or final-partial plaintext block: absorb it into the
+ * CBC-MAC, then XOR it with the next CTR keystream block.
+ */
+static void seal_stream_block(
+  tagotips_seal_stream_t *stream,
+  const uint8_t *data, size_t chunk,
+  uint8_t *out
+) {
+  const uint8_t *rk = stream->session->round_keys;
+  uint8_t ai[16], si[16];
+
+  ccm_mac_absorb(rk, data, chunk, stream->mac);
+
+  ccm_format_ctr(stream->nonce, stream->ctr, ai);
+  aes128_encrypt_block(rk, ai, si);
+  for (size_t i = 0; i < chunk; i++) {
+    out[i] = data[i] ^ si[i];
+  }
+  stream->ctr++;
+}
+
+int32_t tagotips_seal_init(
+  tagotips_seal_stream_t *stream,
+  const tagotips_session_t *session,
+  size_t inner_len,
+  uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  uint8_t out_header[TAGOTIPS_HEADER_SIZE]
+) {
+  if (!stream || !session || !auth_hash || !device_hash || !out_header) {
+    return TAGOTIPS_ERR_NULL_PTR;
+  }
+  if (inner_len > TAGOTIPS_MAX_INNER_FRAME) {
+    return TAGOTIPS_ERR_INNER_TOO_LARGE;
+  }
+
+  uint8_t flags;
+  int32_t rc = flags_encode(0, 0, method, &flags);
+  if (rc != TAGOTIPS_OK) return rc;
+
+  TagotipsHeader hdr;
+  hdr.flags = flags;
+  hdr.counter = counter;
+  memcpy(hdr.auth_hash, auth_hash, 8);
+  memcpy(hdr.device_hash, device_hash, 8);
+  header_to_bytes(&hdr, out_header);
+
+  stream->session = session;
+  construct_nonce(flags, device_hash, counter, stream->nonce);
+
+  /* CBC-MAC over B0 + AAD (the header bytes) */
+  ccm_mac_init(session->round_keys, stream->nonce,
+               out_header, TAGOTIPS_HEADER_SIZE, inner_len, TAGOTIPS_TAG_SIZE,
+               stream->mac);
+
+  /* A0 keystream prefix for the tag */
+  uint8_t ai[16], si[16];
+  ccm_format_ctr(stream->nonce, 0, ai);
+  aes128_encrypt_block(session->round_keys, ai, si);
+  memcpy(stream->s0, si, 8);
+
+  stream->carry_len = 0;
+  stream->fed_len = 0;
+  stream->total_len = inner_len;
+  stream->ctr = 1;
+
+  return TAGOTIPS_OK;
+}
+
+int32_t tagotips_seal_update(
+  tagotips_seal_stream_t *stream,
+  const uint8_t *data, size_t len,
+  uint8_t *out_buf, size_t out_buf_len
+) {
+  if (!stream || !stream->session || (!data && len > 0) || !out_buf) {
+    return TAGOTIPS_ERR_NULL_PTR;
+  }
+  if (stream->fed_len + len > stream->total_len) {
+    return TAGOTIPS_ERR_LENGTH_MISMATCH;
+  }
+
+  size_t emit = ((stream->carry_len + len) / 16) * 16;
+  if (out_buf_len < emit) {
+    return TAGOTIPS_ERR_BUFFER_TOO_SMALL;
+  }
+
+  size_t written = 0;
+
+  /* Top up the carried partial block first */
+  if (stream->carry_len > 0) {
+    size_t fill = 16 - stream->carry_len;
+    if (fill > len) fill = len;
+    memcpy(stream->carry + stream->carry_len, data, fill);
+    stream->carry_len += fill;
+    data += fill;
+    len -= fill;
+    stream->fed_len += fill;
+
+    if (stream->carry_len == 16) {
+      seal_stream_block(stream, stream->carry, 16, out_buf);
+      written += 16;
+      stream->carry_len = 0;
+    }
+  }
+
+  /* Full blocks straight from the caller's buffer */
+  while (len >= 16) {
+    seal_stream_block(stream, data, 16, out_buf + written);
+    written += 16;
+    data += 16;
+    len -= 16;
+    stream->fed_len += 16;
+  }
+
+  /* Stash the tail */
+  if (len > 0) {
+    memcpy(stream->carry, data, len);
+    stream->carry_len = len;
+    stream->fed_len += len;
+  }
+
+  return (int32_t)written;
+}
+
+int32_t tagotips_seal_final(
+  tagotips_seal_stream_t *stream,
+  uint8_t *out_buf, size_t out_buf_len
+) {
+  if (!stream || !stream->session || !out_buf) {
+    return TAGOTIPS_ERR_NULL_PTR;
+  }
+  if (stream->fed_len != stream->total_len) {
+    return TAGOTIPS_ERR_LENGTH_MISMATCH;
+  }
+  if (out_buf_len < stream->carry_len + TAGOTIPS_TAG_SIZE) {
+    return TAGOTIPS_ERR_BUFFER_TOO_SMALL;
+  }
+
+  size_t written = 0;
+
+  /* Flush the final partial block */
+  if (stream->carry_len > 0) {
+    seal_stream_block(stream, stream->carry, stream->carry_len, out_buf);
+    written += stream->carry_len;
+    stream->carry_len = 0;
+  }
+
+  /* Encrypted tag */
+  for (int i = 0; i < 8; i++) {
+    out_buf[written + i] = stream->mac[i] ^ stream->s0[i];
+  }
+  written += 8;
+
+  secure_zero(stream->mac, 16);
+  secure_zero(stream->s0, 8);
+  secure_zero(stream->carry, 16);
+  stream->session = NULL;
+
+  return (int32_t)written;
+}
+
+/* =========================================================================
+ * Cooperative seal -- bounded work per call
+ *
+ * A thin driver over the streaming seal: the task remembers how far
+ * through the inner frame and output buffer it is, and each step feeds
+ * at most max_blocks plaintext blocks, so a sketch can keep servicing
+ * the radio between calls.
+ * ========================================================================= */
+
+int32_t tagotips_seal_start(
+  tagotips_seal_task_t *task,
+  const tagotips_session_t *session,
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  uint8_t *out_buf, size_t out_buf_len
+) {
+  if (!task || !session || !inner_frame || !out_buf) {
+    return TAGOTIPS_ERR_NULL_PTR;
+  }
+  if (inner_len > TAGOTIPS_MAX_INNER_FRAME) {
+    return TAGOTIPS_ERR_INNER_TOO_LARGE;
+  }
+
+  size_t envelope_len = TAGOTIPS_HEADER_SIZE + inner_len + TAGOTIPS_TAG_SIZE;
+  if (out_buf_len < envelope_len) {
+    return TAGOTIPS_ERR_BUFFER_TOO_SMALL;
+  }
+
+  int32_t rc = tagotips_seal_init(&task->stream, session, inner_len,
+                                  method, counter, auth_hash, device_hash,
+                                  out_buf);
+  if (rc != TAGOTIPS_OK) return rc;
+
+  task->inner = inner_frame;
+  task->inner_len = inner_len;
+  task->fed = 0;
+  task->out = out_buf;
+  task->out_pos = TAGOTIPS_HEADER_SIZE;
+  task->out_len = envelope_len;
+  task->done = 0;
+
+  return (int32_t)envelope_len;
+}
+
+int32_t tagotips_seal_step(tagotips_seal_task_t *task, size_t max_blocks) {
+  if (!task) return TAGOTIPS_ERR_NULL_PTR;
+  if (max_blocks == 0) return TAGOTIPS_ERR_INVALID_ARG;
+  if (task->done) return 0;
+
+  size_t remaining = task->inner_len - task->fed;
+  size_t chunk = max_blocks * 16;
+  if (chunk > remaining) chunk = remaining;
+
+  if (chunk > 0) {
+    int32_t rc = tagotips_seal_update(&task->stream, task->inner + task->fed,
+                                      chunk, task->out + task->out_pos,
+                                      task->out_len - task->out_pos);
+    if (rc < 0) return rc;
+    task->fed += chunk;
+    task->out_pos += (size_t)rc;
+  }
+
+  /* The call that consumes the last plaintext also finalizes */
+  if (task->fed == task->inner_len) {
+    int32_t rc = tagotips_seal_final(&task->stream, task->out + task->out_pos,
+                                     task->out_len - task->out_pos);
+    if (rc < 0) return rc;
+    task->out_pos += (size_t)rc;
+    task->done = 1;
+    return 0;
+  }
+
+  /* Whole plaintext blocks left, plus one for the flush + tag */
+  return (int32_t)((task->inner_len - task->fed + 15) / 16 + 1);
+}
+
+/* =========================================================================
+ * Keystream precomputation -- idle-time CTR
+ *
+ * The CTR blocks for a future counter are payload-independent, so a
+ * device can burn idle cycles on them and leave only the CBC-MAC pass
+ * and an XOR between sensor event and bytes-on-air.
+ * ========================================================================= */
+
+int32_t tagotips_keystream_precompute(
+  tagotips_keystream_t *ks,
+  const tagotips_session_t *session,
+  uint8_t method, uint32_t counter,
+  const uint8_t device_hash[8],
+  uint8_t *ks_buf, size_t ks_buf_len
+) {
+  if (!ks || !session || !device_hash || !ks_buf) {
+    return TAGOTIPS_ERR_NULL_PTR;
+  }
+  if (ks_buf_len > TAGOTIPS_MAX_INNER_FRAME) {
+    ks_buf_len = TAGOTIPS_MAX_INNER_FRAME;
+  }
+
+  uint8_t flags;
+  int32_t rc = flags_encode(0, 0, method, &flags);
+  if (rc != TAGOTIPS_OK) return rc;
+
+  uint8_t nonce[TAGOTIPS_NONCE_SIZE];
+  construct_nonce(flags, device_hash, counter, nonce);
+
+  /* A0 block (encrypts the tag) */
+  uint8_t a0[16];
+  ccm_format_ctr(nonce, 0, a0);
+  aes128_encrypt_block(session->round_keys, a0, ks->s0);
+
+  /* Keystream blocks A1.., four counters per stride */
+  size_t filled = 0;
+  uint16_t ctr = 1;
+  while (filled < ks_buf_len) {
+    size_t stride = (ks_buf_len - filled + 15) / 16;
+    if (stride > 4) stride = 4;
+
+    uint8_t actr[64], out[64];
+    for (size_t b = 0; b < stride; b++) {
+      ccm_format_ctr(nonce, (uint16_t)(ctr + b), actr + b * 16);
+    }
+    aes128_encrypt_blocks(session->round_keys, actr, out, stride);
+
+    size_t chunk = stride * 16;
+    if (chunk > ks_buf_len - filled) chunk = ks_buf_len - filled;
+    memcpy(ks_buf + filled, out, chunk);
+    filled += chunk;
+    ctr = (uint16_t)(ctr + stride);
+  }
+
+  ks->flags = flags;
+  ks->counter = counter;
+  memcpy(ks->device_hash, device_hash, 8);
+  ks->ks = ks_buf;
+  ks->ks_len = filled;
+  ks->valid = 1;
+
+  return (int32_t)filled;
+}
+
+int32_t tagotips_seal_precomputed(
+  const tagotips_session_t *session,
+  tagotips_keystream_t *ks,
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  uint8_t *out_buf, size_t out_buf_len
+) {
+  if (!session || !inner_frame || !auth_hash || !device_hash || !out_buf) {
+    return TAGOTIPS_ERR_NULL_PTR;
+  }
+  if (inner_len > TAGOTIPS_MAX_INNER_FRAME) {
+    return TAGOTIPS_ERR_INNER_TOO_LARGE;
+  }
+
+  size_t envelope_len = TAGOTIPS_HEADER_SIZE + inner_len + TAGOTIPS_TAG_SIZE;
+  if (out_buf_len < envelope_len) {
+    STATS_INC(buffer_too_small);
+    return TAGOTIPS_ERR_BUFFER_TOO_SMALL;
+  }
+
+  uint8_t flags;
+  int32_t rc = flags_encode(0, 0, method, &flags);
+  if (rc != TAGOTIPS_OK) return rc;
+
+  /* Fall back to the full computation if the cache does not fit */
+  if (!ks || !ks->valid || ks->flags != flags || ks->counter != counter ||
+      memcmp(ks->device_hash, device_hash, 8) != 0 || ks->ks_len < inner_len) {
+    return seal_with_schedule(session->round_keys, inner_frame, inner_len,
+                              TAGOTIPS_CIPHER_AES128_CCM, method, counter,
+                              auth_hash, device_hash,
+                              out_buf, out_buf_len);
+  }
+
+  /* Build header */
+  TagotipsHeader hdr;
+  hdr.flags = flags;
+  hdr.counter = counter;
+  memcpy(hdr.auth_hash, auth_hash, 8);
+  memcpy(hdr.device_hash, device_hash, 8);
+
+  uint8_t aad[TAGOTIPS_HEADER_SIZE];
+  header_to_bytes(&hdr, aad);
+  memcpy(out_buf, aad, TAGOTIPS_HEADER_SIZE);
+
+  uint8_t nonce[TAGOTIPS_NONCE_SIZE];
+  construct_nonce(flags, device_hash, counter, nonce);
+
+  /* CBC-MAC pass (the only AES work left on the critical path) */
+  uint8_t y[16];
+  ccm_mac_init(session->round_keys, nonce, aad, TAGOTIPS_HEADER_SIZE,
+               inner_len, TAGOTIPS_TAG_SIZE, y);
+  size_t offset = 0;
+  while (offset < inner_len) {
+    size_t chunk = inner_len - offset;
+    if (chunk > 16) chunk = 16;
+    ccm_mac_absorb(session->round_keys, inner_frame + offset, chunk, y);
+    offset += chunk;
+  }
+
+  /* Ciphertext is plaintext XOR cached keystream; tag goes through A0 */
+  uint8_t *ct = out_buf + TAGOTIPS_HEADER_SIZE;
+  for (size_t i = 0; i < inner_len; i++) {
+    ct[i] = inner_frame[i] ^ ks->ks[i];
+  }
+  for (int i = 0; i < TAGOTIPS_TAG_SIZE; i++) {
+    ct[inner_len + i] = y[i] ^ ks->s0[i];
+  }
+
+  /* One precompute, one seal: the keystream is nonce-bound */
+  tagotips_keystream_destroy(ks);
+
+  STATS_INC(frames_sealed);
+  STATS_ADD(bytes_sealed, inner_len);
+  return (int32_t)envelope_len;
+}
+
+void tagotips_keystream_destroy(tagotips_keystream_t *ks) {
+  if (!ks) return;
+  if (ks->ks) secure_zero(ks->ks, ks->ks_len);
+  secure_zero(ks->s0, 16);
+  ks->ks_len = 0;
+  ks->valid = 0;
+}
+
+/* =========================================================================
+ * Identity API -- cached credential derivation
+ * ========================================================================= */
+
+int32_t tagotips_identity_init(tagotips_identity_t *identity,
+                               const char *token, const char *serial) {
+  if (!identity || !token || !serial) return TAGOTIPS_ERR_NULL_PTR;
+
+  tagotips_derive_auth_hash(token, identity->auth_hash);
+  tagotips_derive_device_hash(serial, identity->device_hash);
+
+  uint8_t key[TAGOTIPS_KEY_SIZE];
+  int32_t rc = tagotips_derive_key(token, serial, key, TAGOTIPS_KEY_SIZE);
+  if (rc != TAGOTIPS_OK) return rc;
+
+  rc = tagotips_session_init(&identity->session, key);
+  secure_zero(key, TAGOTIPS_KEY_SIZE);
+  return rc;
+}
+
+int32_t tagotips_identity_seal(
+  const tagotips_identity_t *identity,
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t method, uint32_t counter,
+  uint8_t *out_buf, size_t out_buf_len
+) {
+  if (!identity) return TAGOTIPS_ERR_NULL_PTR;
+  return tagotips_session_seal(&identity->session, inner_frame, inner_len,
+                               method, counter,
+                               identity->auth_hash, identity->device_hash,
+                               out_buf, out_buf_len);
+}
+
+int32_t tagotips_identity_open(
+  const tagotips_identity_t *identity,
+  const uint8_t *envelope, size_t envelope_len,
+  TagotipsHeader *out_header, uint8_t *out_method,
+  uint8_t *out_inner, size_t out_inner_len
+) {
+  if (!identity) return TAGOTIPS_ERR_NULL_PTR;
+  return tagotips_session_open(&identity->session, envelope, envelope_len,
+                               out_header, out_method, out_inner, out_inner_len);
+}
+
+void tagotips_identity_destroy(tagotips_identity_t *identity) {
+  if (!identity) return;
+  secure_zero(identity->auth_hash, 8);
+  secure_zero(identity->device_hash, 8);
+  tagotips_session_destroy(&identity->session);
+}
+
+/* =========================================================================
+ * Key-schedule cache -- gateway-side, indexed by device hash
+ *
+ * Open addressing with linear probing and tombstone deletion. The device
+ * hash is itself truncated SHA-256 output, so its leading bytes are
+ * already well mixed and can index the table directly.
+ * ========================================================================= */
+
+#define KEYCACHE_EMPTY    0
+#define KEYCACHE_USED     1
+#define KEYCACHE_DELETED  2
+
+static size_t keycache_slot(const tagotips_keycache_t *cache,
+                            const uint8_t device_hash[8]) {
+  uint64_t h = 0;
+  for (int i = 0; i < 8; i++) {
+    h = (h << 8) | device_hash[i];
+  }
+  return (size_t)(h & (uint64_t)(cache->capacity - 1));
+}
+
+/* Find the entry for a device hash, or NULL. */
+static tagotips_keycache_entry_t *keycache_find(const tagotips_keycache_t *cache,
+                                                const uint8_t device_hash[8]) {
+  size_t i = keycache_slot(cache, device_hash);
+  for (size_t probes = 0; probes < cache->capacity; probes++) {
+    tagotips_keycache_entry_t *e = &cache->entries[i];
+    if (e->used == KEYCACHE_EMPTY) return NULL;
+    if (e->used == KEYCACHE_USED && memcmp(e->device_hash, device_hash, 8) == 0) {
+      return e;
+    }
+    i = (i + 1) & (cache->capacity - 1);
+  }
+  return NULL;
+}
+
+int32_t tagotips_keycache_init(tagotips_keycache_t *cache,
+                               tagotips_keycache_entry_t *entries,
+                               size_t capacity) {
+  if (!cache || !entries) return TAGOTIPS_ERR_NULL_PTR;
+  if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+    return TAGOTIPS_ERR_INVALID_ARG;
+  }
+  memset(entries, 0, capacity * sizeof(tagotips_keycache_entry_t));
+  cache->entries = entries;
+  cache->capacity = capacity;
+  return TAGOTIPS_OK;
+}
+
+int32_t tagotips_keycache_put(tagotips_keycache_t *cache,
+                              const uint8_t device_hash[8],
+                              const uint8_t key[16]) {
+  if (!cache || !device_hash || !key) return TAGOTIPS_ERR_NULL_PTR;
+
+  /* Re-key an existing entry in place */
+  tagotips_keycache_entry_t *e = keycache_find(cache, device_hash);
+  if (e) {
+    return tagotips_session_init(&e->session, key);
+  }
+
+  /* Insert into the first empty or tombstoned slot */
+  size_t i = keycache_slot(cache, device_hash);
+  for (size_t probes = 0; probes < cache->capacity; probes++) {
+    e = &cache->entries[i];
+    if (e->used != KEYCACHE_USED) {
+      int32_t rc = tagotips_session_init(&e->session, key);
+      if (rc != TAGOTIPS_OK) return rc;
+      memcpy(e->device_hash, device_hash, 8);
+      e->used = KEYCACHE_USED;
+      return TAGOTIPS_OK;
+    }
+    i = (i + 1) & (cache->capacity - 1);
+  }
+  return TAGOTIPS_ERR_BUFFER_TOO_SMALL;
+}
+
+const tagotips_session_t *tagotips_keycache_get(const tagotips_keycache_t *cache,
+                                                const uint8_t device_hash[8]) {
+  if (!cache || !device_hash) return NULL;
+  const tagotips_keycache_entry_t *e = keycache_find(cache, device_hash);
+  return e ? &e->session : NULL;
+}
+
+int32_t tagotips_keycache_remove(tagotips_keycache_t *cache,
+                                 const uint8_t device_hash[8]) {
+  if (!cache || !device_hash) return TAGOTIPS_ERR_NULL_PTR;
+  tagotips_keycache_entry_t *e = keycache_find(cache, device_hash);
+  if (!e) return TAGOTIPS_ERR_UNKNOWN_DEVICE;
+  tagotips_session_destroy(&e->session);
+  secure_zero(e->device_hash, 8);
+  e->used = KEYCACHE_DELETED;
+  return TAGOTIPS_OK;
+}
+
+int32_t tagotips_open_cached(
+  const tagotips_keycache_t *cache,
+  const uint8_t *envelope, size_t envelope_len,
+  TagotipsHeader *out_header, uint8_t *out_method,
+  uint8_t *out_inner, size_t out_inner_len
+) {
+  if (!cache || !envelope || !out_header) return TAGOTIPS_ERR_NULL_PTR;
+
+  /* Header parse gives us the device hash before any crypto */
+  int32_t rc = tagotips_parse_header(envelope, envelope_len, out_header);
+  if (rc != TAGOTIPS_OK) return rc;
+
+  const tagotips_session_t *session =
+    tagotips_keycache_get(cache, out_header->device_hash);
+  if (!session) return TAGOTIPS_ERR_UNKNOWN_DEVICE;
+
+  return open_with_schedule(session->round_keys, envelope, envelope_len,
+                            out_header, out_method, out_inner, out_inner_len);
+}
+
+void tagotips_keycache_destroy(tagotips_keycache_t *cache) {
+  if (!cache || !cache->entries) return;
+  for (size_t i = 0; i < cache->capacity; i++) {
+    tagotips_session_destroy(&cache->entries[i].session);
+    secure_zero(cache->entries[i].device_hash, 8);
+    cache->entries[i].used = KEYCACHE_EMPTY;
+  }
+}
+
+/* =========================================================================
+ * Batch open -- gateway hosts
+ *
+ * Workers pull the next unclaimed item from a shared counter, so cores
+ * stay busy even when envelope sizes are skewed. Device builds compile
+ * the same entry point down to a plain loop.
+ * ========================================================================= */
+
+#ifdef TAGOTIPS_HOST_THREADS
+
+#define BATCH_MAX_THREADS 64
+
+typedef struct {
+  const tagotips_keycache_t *cache;
+  tagotips_batch_item_t *items;
+  size_t count;
+  size_t next;
+  pthread_mutex_t lock;
+} batch_ctx_t;
+
+static void *batch_worker(void *arg) {
+  batch_ctx_t *ctx = (batch_ctx_t *)arg;
+  for (;;) {
+    pthread_mutex_lock(&ctx->lock);
+    size_t i = ctx->next++;
+    pthread_mutex_unlock(&ctx->lock);
+    if (i >= ctx->count) break;
+    tagotips_batch_item_t *item = &ctx->items[i];
+    item->status = tagotips_open_cached(
+      ctx->cache, item->envelope, item->envelope_len,
+      &item->header, &item->method, item->out_inner, item->out_inner_len);
+  }
+  return NULL;
+}
+
+#endif /* TAGOTIPS_HOST_THREADS */
+
+int32_t tagotips_open_batch(const tagotips_keycache_t *cache,
+                            tagotips_batch_item_t *items, size_t count,
+                            size_t num_threads) {
+  if (!cache || (!items && count > 0)) return TAGOTIPS_ERR_NULL_PTR;
+
+#ifdef TAGOTIPS_HOST_THREADS
+  if (num_threads == 0) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    num_threads = online > 0 ? (size_t)online : 1;
+  }
+  if (num_threads > count) num_threads = count;
+  if (num_threads > BATCH_MAX_THREADS) num_threads = BATCH_MAX_THREADS;
+
+  if (num_threads > 1) {
+    batch_ctx_t ctx;
+    ctx.cache = cache;
+    ctx.items = items;
+    ctx.count = count;
+    ctx.next = 0;
+    pthread_mutex_init(&ctx.lock, NULL);
+
+    pthread_t workers[BATCH_MAX_THREADS];
+    size_t spawned = 0;
+    for (size_t t = 0; t + 1 < num_threads; t++) {
+      if (pthread_create(&workers[t], NULL, batch_worker, &ctx) != 0) break;
+      spawned++;
+    }
+    /* The calling thread works too; spawn failures just mean fewer workers */
+    batch_worker(&ctx);
+    for (size_t t = 0; t < spawned; t++) {
+      pthread_join(workers[t], NULL);
+    }
+    pthread_mutex_destroy(&ctx.lock);
+  } else
+#else
+  (void)num_threads;
+#endif
+  {
+    for (size_t i = 0; i < count; i++) {
+      tagotips_batch_item_t *item = &items[i];
+      item->status = tagotips_open_cached(
+        cache, item->envelope, item->envelope_len,
+        &item->header, &item->method, item->out_inner, item->out_inner_len);
+    }
+  }
+
+  int32_t opened = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (items[i].status >= 0) opened++;
+  }
+  return opened;
+}
+
+int32_t tagotips_parse_header(
   const uint8_t *envelope, size_t envelope_len,
   TagotipsHeader *out
 ) {
@@ -733,53 +2231,56 @@ int tagotips_is_envelope(const uint8_t *data, size_t len) {
 
 #define HMAC_BLOCK_SIZE 64
 
-static void hmac_sha256(
+/*
+ * HMAC core with caller-provided scratch. The one-shot wrapper below
+ * keeps the scratch on the stack; the workspace API passes the buffers
+ * embedded in a tagotips_workspace_t. Scratch is wiped before returning.
+ */
+static void hmac_sha256_scratch(
+  tagotips_hmac_scratch_t *s,
   const uint8_t *key, size_t key_len,
   const uint8_t *msg, size_t msg_len,
   uint8_t out[32]
 ) {
-  uint8_t k_pad[HMAC_BLOCK_SIZE];
-  uint8_t ipad[HMAC_BLOCK_SIZE];
-  uint8_t opad[HMAC_BLOCK_SIZE];
-
   /* If key > block size, hash it first */
-  uint8_t key_hash[32];
   if (key_len > HMAC_BLOCK_SIZE) {
-    sha256(key, key_len, key_hash);
-    key = key_hash;
+    sha256(key, key_len, s->key_hash);
+    key = s->key_hash;
     key_len = 32;
   }
 
   /* Pad key to block size */
-  memset(k_pad, 0, HMAC_BLOCK_SIZE);
-  memcpy(k_pad, key, key_len);
+  memset(s->k_pad, 0, HMAC_BLOCK_SIZE);
+  memcpy(s->k_pad, key, key_len);
 
   /* ipad = k_pad XOR 0x36, opad = k_pad XOR 0x5c */
   for (int i = 0; i < HMAC_BLOCK_SIZE; i++) {
-    ipad[i] = k_pad[i] ^ 0x36;
-    opad[i] = k_pad[i] ^ 0x5c;
+    s->ipad[i] = s->k_pad[i] ^ 0x36;
+    s->opad[i] = s->k_pad[i] ^ 0x5c;
   }
 
   /* inner hash: SHA-256(ipad || msg) */
-  sha256_ctx ctx;
-  uint8_t inner_hash[32];
-  sha256_init(&ctx);
-  sha256_update(&ctx, ipad, HMAC_BLOCK_SIZE);
-  sha256_update(&ctx, msg, msg_len);
-  sha256_final(&ctx, inner_hash);
+  sha256_init(&s->ctx);
+  sha256_update(&s->ctx, s->ipad, HMAC_BLOCK_SIZE);
+  sha256_update(&s->ctx, msg, msg_len);
+  sha256_final(&s->ctx, s->inner_hash);
 
   /* outer hash: SHA-256(opad || inner_hash) */
-  sha256_init(&ctx);
-  sha256_update(&ctx, opad, HMAC_BLOCK_SIZE);
-  sha256_update(&ctx, inner_hash, 32);
-  sha256_final(&ctx, out);
+  sha256_init(&s->ctx);
+  sha256_update(&s->ctx, s->opad, HMAC_BLOCK_SIZE);
+  sha256_update(&s->ctx, s->inner_hash, 32);
+  sha256_final(&s->ctx, out);
 
-  secure_zero(k_pad, HMAC_BLOCK_SIZE);
-  secure_zero(ipad, HMAC_BLOCK_SIZE);
-  secure_zero(opad, HMAC_BLOCK_SIZE);
-  secure_zero(inner_hash, 32);
-  secure_zero(key_hash, 32);
-  secure_zero(&ctx, sizeof(ctx));
+  secure_zero(s, sizeof(*s));
+}
+
+static void hmac_sha256(
+  const uint8_t *key, size_t key_len,
+  const uint8_t *msg, size_t msg_len,
+  uint8_t out[32]
+) {
+  tagotips_hmac_scratch_t scratch;
+  hmac_sha256_scratch(&scratch, key, key_len, msg, msg_len, out);
 }
 
 /* =========================================================================
@@ -806,6 +2307,228 @@ int32_t tagotips_derive_key(const char *token, const char *serial,
   return TAGOTIPS_OK;
 }
 
+int32_t tagotips_hmac_key_init(tagotips_hmac_key_t *hmac_key, const char *token) {
+  if (!hmac_key || !token) return TAGOTIPS_ERR_NULL_PTR;
+
+  const char *hex_part = token;
+  if (token[0] == 'a' && token[1] == 't') {
+    hex_part = token + 2;
+  }
+
+  const uint8_t *key = (const uint8_t *)hex_part;
+  size_t key_len = strlen(hex_part);
+
+  /* If key > block size, hash it first */
+  uint8_t key_hash[32];
+  if (key_len > HMAC_BLOCK_SIZE) {
+    sha256(key, key_len, key_hash);
+    key = key_hash;
+    key_len = 32;
+  }
+
+  /* Pad key to block size */
+  uint8_t k_pad[HMAC_BLOCK_SIZE];
+  uint8_t pad[HMAC_BLOCK_SIZE];
+  memset(k_pad, 0, HMAC_BLOCK_SIZE);
+  memcpy(k_pad, key, key_len);
+
+  /* Absorb ipad into the cached inner state */
+  for (int i = 0; i < HMAC_BLOCK_SIZE; i++) pad[i] = k_pad[i] ^ 0x36;
+  sha256_init(&hmac_key->inner);
+  sha256_update(&hmac_key->inner, pad, HMAC_BLOCK_SIZE);
+
+  /* Absorb opad into the cached outer state */
+  for (int i = 0; i < HMAC_BLOCK_SIZE; i++) pad[i] = k_pad[i] ^ 0x5c;
+  sha256_init(&hmac_key->outer);
+  sha256_update(&hmac_key->outer, pad, HMAC_BLOCK_SIZE);
+
+  secure_zero(k_pad, HMAC_BLOCK_SIZE);
+  secure_zero(pad, HMAC_BLOCK_SIZE);
+  secure_zero(key_hash, 32);
+  return TAGOTIPS_OK;
+}
+
+int32_t tagotips_derive_key_cached(const tagotips_hmac_key_t *hmac_key,
+                                   const char *serial,
+                                   uint8_t *out_key, size_t key_len) {
+  if (!hmac_key || !serial || !out_key) return TAGOTIPS_ERR_NULL_PTR;
+  if (key_len == 0 || key_len > 32) return TAGOTIPS_ERR_BUFFER_TOO_SMALL;
+
+  /* inner hash: resume cached SHA-256(ipad || ...) with the message */
+  sha256_ctx ctx = hmac_key->inner;
+  uint8_t inner_hash[32];
+  sha256_update(&ctx, (const uint8_t *)serial, strlen(serial));
+  sha256_final(&ctx, inner_hash);
+
+  /* outer hash: resume cached SHA-256(opad || ...) with the inner hash */
+  uint8_t full_key[32];
+  ctx = hmac_key->outer;
+  sha256_update(&ctx, inner_hash, 32);
+  sha256_final(&ctx, full_key);
+
+  memcpy(out_key, full_key, key_len);
+  secure_zero(full_key, 32);
+  secure_zero(inner_hash, 32);
+  secure_zero(&ctx, sizeof(ctx));
+  return TAGOTIPS_OK;
+}
+
+void tagotips_hmac_key_destroy(tagotips_hmac_key_t *hmac_key) {
+  if (!hmac_key) return;
+  secure_zero(hmac_key, sizeof(*hmac_key));
+}
+
+/* =========================================================================
+ * Workspace API -- caller-provided crypto scratch
+ *
+ * Same semantics as the one-shot entry points, but the key schedule and
+ * HMAC scratch live in the caller's tagotips_workspace_t instead of on
+ * the stack, so RTOS task stacks no longer have to be sized for the
+ * crypto worst case. Key material in the workspace is wiped before each
+ * call returns.
+ * ========================================================================= */
+
+int32_t tagotips_workspace_seal(
+  tagotips_workspace_t *ws,
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  const uint8_t key[16],
+  uint8_t *out_buf, size_t out_buf_len
+) {
+  if (!ws || !key) return TAGOTIPS_ERR_NULL_PTR;
+
+  aes128_key_expansion(key, ws->round_keys);
+
+  int32_t rc = seal_with_schedule(ws->round_keys, inner_frame, inner_len,
+                                  TAGOTIPS_CIPHER_AES128_CCM, method, counter,
+                                  auth_hash, device_hash,
+                                  out_buf, out_buf_len);
+
+  secure_zero(ws->round_keys, 176);
+  return rc;
+}
+
+int32_t tagotips_workspace_open(
+  tagotips_workspace_t *ws,
+  const uint8_t *envelope, size_t envelope_len,
+  const uint8_t key[16],
+  TagotipsHeader *out_header, uint8_t *out_method,
+  uint8_t *out_inner, size_t out_inner_len
+) {
+  if (!ws || !key) return TAGOTIPS_ERR_NULL_PTR;
+
+  aes128_key_expansion(key, ws->round_keys);
+
+  int32_t rc = open_with_schedule(ws->round_keys, envelope, envelope_len,
+                                  out_header, out_method, out_inner, out_inner_len);
+
+  secure_zero(ws->round_keys, 176);
+  return rc;
+}
+
+int32_t tagotips_workspace_derive_key(
+  tagotips_workspace_t *ws,
+  const char *token, const char *serial,
+  uint8_t *out_key, size_t key_len
+) {
+  if (!ws || !token || !serial || !out_key) return TAGOTIPS_ERR_NULL_PTR;
+  if (key_len == 0 || key_len > 32) return TAGOTIPS_ERR_BUFFER_TOO_SMALL;
+
+  const char *hex_part = token;
+  if (token[0] == 'a' && token[1] == 't') {
+    hex_part = token + 2;
+  }
+
+  uint8_t full_key[32];
+  hmac_sha256_scratch(&ws->hmac,
+                      (const uint8_t *)hex_part, strlen(hex_part),
+                      (const uint8_t *)serial, strlen(serial),
+                      full_key);
+
+  memcpy(out_key, full_key, key_len);
+  secure_zero(full_key, 32);
+  return TAGOTIPS_OK;
+}
+
+void tagotips_workspace_destroy(tagotips_workspace_t *ws) {
+  if (!ws) return;
+  secure_zero(ws, sizeof(*ws));
+}
+
+/* =========================================================================
+ * Counter manager -- persistent monotonic counter, batched flash commits
+ *
+ * The persisted value is always a forward reservation: before any
+ * counter in [next, next + step) is handed out, next + step is written
+ * through the store callback. A reset inside the window therefore
+ * resumes at the stored bound and can never repeat a nonce, while flash
+ * sees one write per step increments instead of one per uplink.
+ * ========================================================================= */
+
+int32_t tagotips_counter_init(
+  tagotips_counter_t *counter, uint32_t last_committed, uint32_t step,
+  tagotips_counter_store_fn store, void *user
+) {
+  if (!counter || !store) return TAGOTIPS_ERR_NULL_PTR;
+  if (step == 0) return TAGOTIPS_ERR_INVALID_ARG;
+
+  counter->next = last_committed;
+  counter->reserved = last_committed;
+  counter->step = step;
+  counter->store = store;
+  counter->user = user;
+  return TAGOTIPS_OK;
+}
+
+int32_t tagotips_counter_next(tagotips_counter_t *counter, uint32_t *out) {
+  if (!counter || !out) return TAGOTIPS_ERR_NULL_PTR;
+
+  if (counter->next >= counter->reserved) {
+    /* Window exhausted: reserve the next one before handing out values */
+    if (counter->next == UINT32_MAX) return TAGOTIPS_ERR_COUNTER_EXHAUSTED;
+
+    uint32_t bound = counter->next + counter->step;
+    if (bound < counter->next) {
+      bound = UINT32_MAX; /* clamp the final window at the top of range */
+    }
+    if (counter->store(bound, counter->user) != TAGOTIPS_OK) {
+      return TAGOTIPS_ERR_STORAGE_FAILED;
+    }
+    counter->reserved = bound;
+  }
+
+  *out = counter->next++;
+  return TAGOTIPS_OK;
+}
+
+int32_t tagotips_counter_flush(tagotips_counter_t *counter) {
+  if (!counter) return TAGOTIPS_ERR_NULL_PTR;
+
+  if (counter->store(counter->next, counter->user) != TAGOTIPS_OK) {
+    return TAGOTIPS_ERR_STORAGE_FAILED;
+  }
+  counter->reserved = counter->next;
+  return TAGOTIPS_OK;
+}
+
+int32_t tagotips_counter_seal(
+  tagotips_counter_t *counter,
+  const tagotips_session_t *session,
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t method,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  uint8_t *out_buf, size_t out_buf_len
+) {
+  uint32_t value;
+  int32_t rc = tagotips_counter_next(counter, &value);
+  if (rc != TAGOTIPS_OK) return rc;
+
+  return tagotips_session_seal(session, inner_frame, inner_len,
+                               method, value, auth_hash, device_hash,
+                               out_buf, out_buf_len);
+}
+
 static int hex_char_value(char c) {
   if (c >= '0' && c <= '9') return c - '0';
   if (c >= 'a' && c <= 'f') return c - 'a' + 10;
@@ -25,6 +25,7 @@ extern "C" {
 #define TAGOTIPS_HASH_SIZE          8
 #define TAGOTIPS_KEY_SIZE          16
 #define TAGOTIPS_TAG_SIZE           8
+#define TAGOTIPS_CCM4_TAG_SIZE      4
 #define TAGOTIPS_NONCE_SIZE        13
 #define TAGOTIPS_MAX_INNER_FRAME 16384
 #define TAGOTIPS_MAX_ENVELOPE    16413  /* HEADER + MAX_INNER + TAG */
@@ -44,6 +45,11 @@ extern "C" {
 #define TAGOTIPS_ERR_INNER_TOO_LARGE      -9
 #define TAGOTIPS_ERR_RESERVED_FLAGS       -10
 #define TAGOTIPS_ERR_INVALID_HEX         -11
+#define TAGOTIPS_ERR_LENGTH_MISMATCH     -12
+#define TAGOTIPS_ERR_INVALID_ARG         -13
+#define TAGOTIPS_ERR_UNKNOWN_DEVICE      -14
+#define TAGOTIPS_ERR_COUNTER_EXHAUSTED   -15
+#define TAGOTIPS_ERR_STORAGE_FAILED      -16
 
 /* -----------------------------------------------------------------------
  * Envelope methods
@@ -54,6 +60,18 @@ extern "C" {
 #define TAGOTIPS_METHOD_PING  2
 #define TAGOTIPS_METHOD_ACK   3
 
+/* -----------------------------------------------------------------------
+ * Cipher suites (Flags bits 7-5)
+ *
+ * Codes 1-4 (GCM / AES-256 / ChaCha20) are server-side suites this
+ * library does not implement. Code 5 truncates the CCM tag to 4 bytes,
+ * trading forgery margin for 4 bytes of airtime per frame on
+ * duty-cycle-limited links; open detects it from the flags byte.
+ * ----------------------------------------------------------------------- */
+
+#define TAGOTIPS_CIPHER_AES128_CCM    0  /* AES-128-CCM, 8-byte tag (default) */
+#define TAGOTIPS_CIPHER_AES128_CCM_4  5  /* AES-128-CCM, 4-byte truncated tag */
+
 /* -----------------------------------------------------------------------
  * Types
  * ----------------------------------------------------------------------- */
@@ -65,6 +83,115 @@ typedef struct {
   uint8_t  device_hash[8];
 } TagotipsHeader;
 
+/**
+ * Session context holding a pre-expanded AES key schedule.
+ *
+ * Treat the contents as internal: initialize with tagotips_session_init()
+ * and wipe with tagotips_session_destroy() when the key is no longer needed.
+ */
+typedef struct {
+  uint8_t round_keys[176];
+} tagotips_session_t;
+
+/**
+ * Device identity context: the auth hash, device hash, and expanded
+ * encryption key derived from a token + serial pair, computed once at
+ * tagotips_identity_init() so reconnects don't repeat the derivation.
+ * Wipe with tagotips_identity_destroy() at teardown.
+ */
+typedef struct {
+  uint8_t auth_hash[8];
+  uint8_t device_hash[8];
+  tagotips_session_t session;
+} tagotips_identity_t;
+
+/**
+ * Streaming seal state (see tagotips_seal_init/update/final).
+ *
+ * Holds one 16-byte block of carry between calls plus the running
+ * CBC-MAC and CTR position. Treat the contents as internal. The session
+ * passed to tagotips_seal_init() must outlive the stream.
+ */
+typedef struct {
+  const tagotips_session_t *session;
+  uint8_t  mac[16];       /* running CBC-MAC state */
+  uint8_t  s0[8];         /* A0 keystream prefix (encrypts the tag) */
+  uint8_t  nonce[13];
+  uint8_t  carry[16];     /* buffered partial plaintext block */
+  size_t   carry_len;
+  size_t   fed_len;       /* plaintext bytes fed so far */
+  size_t   total_len;     /* declared plaintext length */
+  uint16_t ctr;           /* next CTR block index */
+} tagotips_seal_stream_t;
+
+/**
+ * Cooperative seal task state (see tagotips_seal_start/step). Wraps a
+ * streaming seal plus the input/output cursors, so a sketch can spread
+ * one seal across loop() iterations. Treat the contents as internal;
+ * the session, inner frame, and output buffer passed to
+ * tagotips_seal_start() must outlive the task.
+ */
+typedef struct {
+  tagotips_seal_stream_t stream;
+  const uint8_t *inner;
+  size_t inner_len;
+  size_t fed;
+  uint8_t *out;
+  size_t out_pos;
+  size_t out_len;
+  uint8_t done;
+} tagotips_seal_task_t;
+
+/**
+ * Precomputed CTR keystream for one future envelope (see
+ * tagotips_keystream_precompute). In CCM the keystream depends only on
+ * the key, flags, device hash, and counter -- all known before the
+ * payload exists -- so it can be computed during radio-idle time. The
+ * keystream bytes live in a caller-owned buffer; treat the fields as
+ * internal. Each precompute is valid for exactly one seal: the
+ * keystream is wiped on use, since reusing it would reuse the nonce.
+ */
+typedef struct {
+  uint8_t  flags;
+  uint32_t counter;
+  uint8_t  device_hash[8];
+  uint8_t  s0[16];        /* A0 block (encrypts the tag) */
+  uint8_t *ks;            /* caller-owned keystream bytes */
+  size_t   ks_len;
+  uint8_t  valid;
+} tagotips_keystream_t;
+
+/**
+ * Incremental SHA-256 context (FIPS 180-4).
+ * Initialize with tagotips_sha256_init(); the fields are internal.
+ */
+typedef struct {
+  uint32_t state[8];
+  uint8_t  buf[64];
+  uint64_t total;
+} tagotips_sha256_ctx;
+
+/* -----------------------------------------------------------------------
+ * Streaming SHA-256
+ * ----------------------------------------------------------------------- */
+
+/**
+ * Initialize a streaming SHA-256 context.
+ */
+void tagotips_sha256_init(tagotips_sha256_ctx *ctx);
+
+/**
+ * Absorb data into a streaming SHA-256 context. May be called any number
+ * of times with arbitrary chunk sizes.
+ */
+void tagotips_sha256_update(tagotips_sha256_ctx *ctx, const uint8_t *data, size_t len);
+
+/**
+ * Finalize and write the 32-byte digest. The context must be
+ * re-initialized before reuse.
+ */
+void tagotips_sha256_final(tagotips_sha256_ctx *ctx, uint8_t digest[32]);
+
 /* -----------------------------------------------------------------------
  * Hash derivation
  * ----------------------------------------------------------------------- */
@@ -98,12 +225,28 @@ int32_t tagotips_seal(
   const uint8_t key[16],
   uint8_t *out_buf, size_t out_buf_len);
 
+/**
+ * Seal with an explicit cipher suite (see the TAGOTIPS_CIPHER_* codes).
+ * TAGOTIPS_CIPHER_AES128_CCM_4 shaves 4 tag bytes off every envelope for
+ * airtime-constrained links; tagotips_seal() is equivalent to passing
+ * TAGOTIPS_CIPHER_AES128_CCM.
+ *
+ * Returns bytes written to out_buf on success, or a negative error code.
+ */
+int32_t tagotips_seal_cipher(
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t cipher, uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  const uint8_t key[16],
+  uint8_t *out_buf, size_t out_buf_len);
+
 /* -----------------------------------------------------------------------
  * Open (decrypt envelope)
  * ----------------------------------------------------------------------- */
 
 /**
- * Decrypt a TagoTiP/S envelope.
+ * Decrypt a TagoTiP/S envelope. The cipher suite is detected from the
+ * flags byte (standard 8-byte and truncated 4-byte CCM tags).
  *
  * Returns inner frame length on success, or a negative error code.
  * On authentication failure the output buffer is zeroed.
@@ -114,6 +257,550 @@ int32_t tagotips_open(
   TagotipsHeader *out_header, uint8_t *out_method,
   uint8_t *out_inner, size_t out_inner_len);
 
+/* -----------------------------------------------------------------------
+ * In-place seal/open (single buffer)
+ * ----------------------------------------------------------------------- */
+
+/**
+ * Seal in place: the caller builds the plaintext inner frame at offset
+ * TAGOTIPS_HEADER_SIZE inside buf; on success the buffer holds the
+ * complete envelope (header + ciphertext + tag). buf_len must be at
+ * least TAGOTIPS_HEADER_SIZE + inner_len + TAGOTIPS_TAG_SIZE.
+ *
+ * Returns envelope length on success, or a negative error code.
+ */
+int32_t tagotips_seal_inplace(
+  uint8_t *buf, size_t buf_len, size_t inner_len,
+  uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  const uint8_t key[16]);
+
+/**
+ * Open in place: decrypts the envelope buffer in situ. On success the
+ * plaintext inner frame starts at buf + TAGOTIPS_HEADER_SIZE.
+ * On authentication failure the plaintext region is zeroed.
+ *
+ * Returns inner frame length on success, or a negative error code.
+ */
+int32_t tagotips_open_inplace(
+  uint8_t *buf, size_t envelope_len,
+  const uint8_t key[16],
+  TagotipsHeader *out_header, uint8_t *out_method);
+
+/* -----------------------------------------------------------------------
+ * Session API (cached key schedule)
+ * ----------------------------------------------------------------------- */
+
+/**
+ * Initialize a session: expands the key once so repeated seal/open calls
+ * skip per-call key expansion. Returns 0 on success, or a negative error code.
+ */
+int32_t tagotips_session_init(tagotips_session_t *session, const uint8_t key[16]);
+
+/**
+ * Seal an inner frame using a session's cached key schedule.
+ * Same semantics as tagotips_seal().
+ */
+int32_t tagotips_session_seal(
+  const tagotips_session_t *session,
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  uint8_t *out_buf, size_t out_buf_len);
+
+/**
+ * Session variant of tagotips_seal_cipher().
+ */
+int32_t tagotips_session_seal_cipher(
+  const tagotips_session_t *session,
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t cipher, uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  uint8_t *out_buf, size_t out_buf_len);
+
+/**
+ * Open an envelope using a session's cached key schedule.
+ * Same semantics as tagotips_open().
+ */
+int32_t tagotips_session_open(
+  const tagotips_session_t *session,
+  const uint8_t *envelope, size_t envelope_len,
+  TagotipsHeader *out_header, uint8_t *out_method,
+  uint8_t *out_inner, size_t out_inner_len);
+
+/**
+ * In-place variant of tagotips_session_seal().
+ * Same buffer contract as tagotips_seal_inplace().
+ */
+int32_t tagotips_session_seal_inplace(
+  const tagotips_session_t *session,
+  uint8_t *buf, size_t buf_len, size_t inner_len,
+  uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8]);
+
+/**
+ * In-place variant of tagotips_session_open().
+ * Same buffer contract as tagotips_open_inplace().
+ */
+int32_t tagotips_session_open_inplace(
+  const tagotips_session_t *session,
+  uint8_t *buf, size_t envelope_len,
+  TagotipsHeader *out_header, uint8_t *out_method);
+
+/**
+ * Wipe the cached key schedule. Call once at teardown.
+ */
+void tagotips_session_destroy(tagotips_session_t *session);
+
+/* -----------------------------------------------------------------------
+ * Workspace API (caller-provided crypto scratch)
+ * ----------------------------------------------------------------------- */
+
+/**
+ * HMAC-SHA256 scratch buffers. Internal detail of tagotips_workspace_t.
+ */
+typedef struct {
+  uint8_t k_pad[64];
+  uint8_t ipad[64];
+  uint8_t opad[64];
+  uint8_t key_hash[32];
+  uint8_t inner_hash[32];
+  tagotips_sha256_ctx ctx;
+} tagotips_hmac_scratch_t;
+
+/**
+ * Caller-provided crypto workspace. The one-shot seal/open paths put the
+ * 176-byte AES key schedule on the stack and key derivation adds ~360
+ * bytes of HMAC scratch; under an RTOS every task stack must be sized
+ * for that worst case. The workspace variants place this state in a
+ * caller-owned (typically statically allocated) structure instead, so
+ * the crypto stack high-water mark stays small and deterministic.
+ *
+ * Treat the fields as internal. Key material in the workspace is wiped
+ * before each call returns; wipe the whole structure with
+ * tagotips_workspace_destroy() at teardown. One workspace serves one
+ * task at a time -- it is not safe for concurrent use.
+ */
+typedef struct {
+  uint8_t round_keys[176];
+  tagotips_hmac_scratch_t hmac;
+} tagotips_workspace_t;
+
+/**
+ * Workspace variant of tagotips_seal(): the key schedule lives in the
+ * workspace instead of the stack. Same semantics and return values.
+ */
+int32_t tagotips_workspace_seal(
+  tagotips_workspace_t *ws,
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  const uint8_t key[16],
+  uint8_t *out_buf, size_t out_buf_len);
+
+/**
+ * Workspace variant of tagotips_open(). Same semantics and return values.
+ */
+int32_t tagotips_workspace_open(
+  tagotips_workspace_t *ws,
+  const uint8_t *envelope, size_t envelope_len,
+  const uint8_t key[16],
+  TagotipsHeader *out_header, uint8_t *out_method,
+  uint8_t *out_inner, size_t out_inner_len);
+
+/**
+ * Workspace variant of tagotips_derive_key(): the HMAC pads and hash
+ * context live in the workspace. Same semantics and return values.
+ */
+int32_t tagotips_workspace_derive_key(
+  tagotips_workspace_t *ws,
+  const char *token, const char *serial,
+  uint8_t *out_key, size_t key_len);
+
+/**
+ * Wipe the whole workspace. Call once at teardown.
+ */
+void tagotips_workspace_destroy(tagotips_workspace_t *ws);
+
+/* -----------------------------------------------------------------------
+ * Counter manager (persistent monotonic counter)
+ * ----------------------------------------------------------------------- */
+
+/**
+ * Persist a counter reservation. Called by the counter manager every N
+ * increments; the callback writes `value` to flash/EEPROM and returns
+ * TAGOTIPS_OK, or any other value to signal a write failure. `user` is
+ * the opaque pointer passed to tagotips_counter_init().
+ */
+typedef int32_t (*tagotips_counter_store_fn)(uint32_t value, void *user);
+
+/**
+ * Monotonic counter manager. The envelope counter must never repeat for
+ * a key (it is embedded in the CCM nonce), so it has to survive resets
+ * -- but persisting every increment wears flash and slows every uplink.
+ * The manager instead persists a forward reservation: the stored value
+ * is an exclusive upper bound on every counter ever handed out, written
+ * once per N increments. On boot the stored value is safe to resume at
+ * directly, even if the device died mid-window.
+ *
+ * Treat the fields as internal.
+ */
+typedef struct {
+  uint32_t next;      /* next counter value to hand out */
+  uint32_t reserved;  /* exclusive upper bound of the persisted window */
+  uint32_t step;      /* commit interval N */
+  tagotips_counter_store_fn store;
+  void *user;
+} tagotips_counter_t;
+
+/**
+ * Initialize a counter manager. `last_committed` is the value most
+ * recently handed to the store callback (0 on first boot); counters
+ * resume there. `step` is the commit interval N: one flash write per N
+ * uplinks, at the cost of skipping at most N-1 counter values on an
+ * unclean reset. Returns 0 on success, or a negative error code.
+ */
+int32_t tagotips_counter_init(
+  tagotips_counter_t *counter, uint32_t last_committed, uint32_t step,
+  tagotips_counter_store_fn store, void *user);
+
+/**
+ * Hand out the next counter value. Persists a new reservation via the
+ * store callback when the current window is exhausted (every N calls).
+ * Returns 0 on success, TAGOTIPS_ERR_STORAGE_FAILED if the callback
+ * failed (the counter does not advance), or
+ * TAGOTIPS_ERR_COUNTER_EXHAUSTED once the 32-bit space is spent.
+ */
+int32_t tagotips_counter_next(tagotips_counter_t *counter, uint32_t *out);
+
+/**
+ * Persist the exact current position, closing the open window. Call on
+ * graceful shutdown so the next boot resumes without skipping values.
+ * Returns 0 on success, or a negative error code.
+ */
+int32_t tagotips_counter_flush(tagotips_counter_t *counter);
+
+/**
+ * Seal an inner frame with the next managed counter value, using a
+ * session's cached key schedule. A drawn counter value is consumed even
+ * if sealing then fails -- it must not be reused for another nonce.
+ * Returns bytes written to out_buf on success, or a negative error code.
+ */
+int32_t tagotips_counter_seal(
+  tagotips_counter_t *counter,
+  const tagotips_session_t *session,
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t method,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  uint8_t *out_buf, size_t out_buf_len);
+
+/* -----------------------------------------------------------------------
+ * Identity API (cached credential derivation)
+ * ----------------------------------------------------------------------- */
+
+/**
+ * Derive the auth hash, device hash, and encryption key from a token and
+ * serial in one shot (four SHA-256 compressions plus one HMAC), and
+ * expand the key schedule. Subsequent seal/open calls through the
+ * identity are pure crypto with no per-connection derivation.
+ *
+ * Returns 0 on success, or a negative error code.
+ */
+int32_t tagotips_identity_init(tagotips_identity_t *identity,
+                               const char *token, const char *serial);
+
+/**
+ * Seal an inner frame using a cached identity.
+ * Same semantics as tagotips_seal().
+ */
+int32_t tagotips_identity_seal(
+  const tagotips_identity_t *identity,
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t method, uint32_t counter,
+  uint8_t *out_buf, size_t out_buf_len);
+
+/**
+ * Open an envelope using a cached identity.
+ * Same semantics as tagotips_open().
+ */
+int32_t tagotips_identity_open(
+  const tagotips_identity_t *identity,
+  const uint8_t *envelope, size_t envelope_len,
+  TagotipsHeader *out_header, uint8_t *out_method,
+  uint8_t *out_inner, size_t out_inner_len);
+
+/**
+ * Wipe the cached hashes and key schedule. Call once at teardown.
+ */
+void tagotips_identity_destroy(tagotips_identity_t *identity);
+
+/* -----------------------------------------------------------------------
+ * Key-schedule cache (gateway-side, indexed by device hash)
+ * ----------------------------------------------------------------------- */
+
+/**
+ * One key-cache slot: a device hash and its pre-expanded key schedule.
+ * The fields are internal.
+ */
+typedef struct {
+  uint8_t used;
+  uint8_t device_hash[8];
+  tagotips_session_t session;
+} tagotips_keycache_entry_t;
+
+/**
+ * Open-addressing key-schedule cache keyed by device hash, for gateways
+ * decrypting traffic from many devices. The caller owns the entry array
+ * (heap or static), so a 10k-device concentrator and a 4-device test rig
+ * use the same code. Initialize with tagotips_keycache_init().
+ */
+typedef struct {
+  tagotips_keycache_entry_t *entries;
+  size_t capacity;
+} tagotips_keycache_t;
+
+/**
+ * Initialize a key cache over a caller-owned entry array. capacity must
+ * be a power of two; size it at roughly twice the expected device count
+ * to keep probe chains short. Returns 0 on success, or a negative error
+ * code.
+ */
+int32_t tagotips_keycache_init(tagotips_keycache_t *cache,
+                               tagotips_keycache_entry_t *entries,
+                               size_t capacity);
+
+/**
+ * Insert or replace the key for a device hash, expanding the key schedule
+ * once at insert time. Returns 0 on success, TAGOTIPS_ERR_BUFFER_TOO_SMALL
+ * if the cache is full, or another negative error code.
+ */
+int32_t tagotips_keycache_put(tagotips_keycache_t *cache,
+                              const uint8_t device_hash[8],
+                              const uint8_t key[16]);
+
+/**
+ * Look up the cached session for a device hash. Returns NULL if absent.
+ */
+const tagotips_session_t *tagotips_keycache_get(const tagotips_keycache_t *cache,
+                                                const uint8_t device_hash[8]);
+
+/**
+ * Remove a device's entry, wiping its key schedule. Returns 0 on success
+ * or TAGOTIPS_ERR_UNKNOWN_DEVICE if the hash is not cached.
+ */
+int32_t tagotips_keycache_remove(tagotips_keycache_t *cache,
+                                 const uint8_t device_hash[8]);
+
+/**
+ * Decrypt an envelope using the cache: parses the header, probes for the
+ * device hash, and opens with the cached key schedule in one call.
+ * Same output semantics as tagotips_open(); additionally returns
+ * TAGOTIPS_ERR_UNKNOWN_DEVICE if the device hash is not cached.
+ *
+ * Returns inner frame length on success, or a negative error code.
+ */
+int32_t tagotips_open_cached(
+  const tagotips_keycache_t *cache,
+  const uint8_t *envelope, size_t envelope_len,
+  TagotipsHeader *out_header, uint8_t *out_method,
+  uint8_t *out_inner, size_t out_inner_len);
+
+/**
+ * Wipe every cached key schedule. Call once at teardown.
+ */
+void tagotips_keycache_destroy(tagotips_keycache_t *cache);
+
+/* -----------------------------------------------------------------------
+ * Batch open (gateway hosts)
+ * ----------------------------------------------------------------------- */
+
+/**
+ * One envelope in a tagotips_open_batch() call. The caller fills the
+ * first four fields; the rest are outputs. status holds the inner frame
+ * length on success or a negative error code, with the same semantics
+ * as tagotips_open_cached().
+ */
+typedef struct {
+  const uint8_t *envelope;
+  size_t envelope_len;
+  uint8_t *out_inner;
+  size_t out_inner_len;
+  TagotipsHeader header;
+  uint8_t method;
+  int32_t status;
+} tagotips_batch_item_t;
+
+/**
+ * Open a batch of envelopes against a key cache. Envelopes are
+ * cryptographically independent, so compiling with TAGOTIPS_HOST_THREADS
+ * (and linking -pthread) spreads the batch across worker threads that
+ * pull items from a shared queue -- slow and fast envelopes balance out
+ * automatically. num_threads caps the worker count; 0 means one per
+ * online core. Without TAGOTIPS_HOST_THREADS the batch runs sequentially
+ * on the calling thread, so device and gateway builds share one API.
+ *
+ * Each item's status is always written. Returns the number of envelopes
+ * opened successfully, or a negative error code if the arguments are
+ * invalid.
+ */
+int32_t tagotips_open_batch(const tagotips_keycache_t *cache,
+                            tagotips_batch_item_t *items, size_t count,
+                            size_t num_threads);
+
+/* -----------------------------------------------------------------------
+ * Statistics (opt-in, compile with -DTAGOTIPS_STATS)
+ * ----------------------------------------------------------------------- */
+
+#ifdef TAGOTIPS_STATS
+
+/**
+ * Monotonic counters over every seal/open entry point (one-shot,
+ * in-place, session, cached, batch). Maintained inline in the hot paths
+ * when the library is compiled with TAGOTIPS_STATS; default builds carry
+ * no instrumentation at all. The counters are not atomic -- on threaded
+ * gateway builds treat a snapshot as approximate.
+ */
+typedef struct {
+  uint32_t frames_sealed;     /* envelopes produced */
+  uint32_t frames_opened;     /* envelopes authenticated and decrypted */
+  uint64_t bytes_sealed;      /* plaintext bytes encrypted */
+  uint64_t bytes_opened;      /* plaintext bytes recovered */
+  uint32_t auth_failures;     /* CCM tag mismatches on open */
+  uint32_t buffer_too_small;  /* seal/open rejections for short buffers */
+} tagotips_stats_t;
+
+/**
+ * Copy a snapshot of the counters into *out.
+ */
+void tagotips_get_stats(tagotips_stats_t *out);
+
+/**
+ * Zero all counters (e.g. after shipping a telemetry report).
+ */
+void tagotips_reset_stats(void);
+
+#endif /* TAGOTIPS_STATS */
+
+/* -----------------------------------------------------------------------
+ * Streaming seal (init / update / final)
+ * ----------------------------------------------------------------------- */
+
+/**
+ * Begin a streaming seal. CCM commits to the plaintext length up front,
+ * so inner_len must be the exact number of bytes that will be fed via
+ * tagotips_seal_update(). Writes the 21-byte envelope header to
+ * out_header; the caller transmits it before the ciphertext.
+ *
+ * Returns 0 on success, or a negative error code.
+ */
+int32_t tagotips_seal_init(
+  tagotips_seal_stream_t *stream,
+  const tagotips_session_t *session,
+  size_t inner_len,
+  uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  uint8_t out_header[TAGOTIPS_HEADER_SIZE]);
+
+/**
+ * Feed plaintext into a streaming seal. Ciphertext is emitted in whole
+ * 16-byte blocks; up to 15 bytes are carried between calls. out_buf must
+ * hold ((carry + len) / 16) * 16 bytes.
+ *
+ * Returns bytes written to out_buf, or a negative error code.
+ */
+int32_t tagotips_seal_update(
+  tagotips_seal_stream_t *stream,
+  const uint8_t *data, size_t len,
+  uint8_t *out_buf, size_t out_buf_len);
+
+/**
+ * Finish a streaming seal: flushes the carried partial block and appends
+ * the 8-byte auth tag. Fails with TAGOTIPS_ERR_LENGTH_MISMATCH if the
+ * bytes fed do not match the length declared at init. out_buf must hold
+ * carry + TAGOTIPS_TAG_SIZE bytes.
+ *
+ * Returns bytes written to out_buf, or a negative error code.
+ */
+int32_t tagotips_seal_final(
+  tagotips_seal_stream_t *stream,
+  uint8_t *out_buf, size_t out_buf_len);
+
+/* -----------------------------------------------------------------------
+ * Cooperative seal (start / step)
+ * ----------------------------------------------------------------------- */
+
+/**
+ * Begin a cooperative seal over a complete inner frame. Writes the
+ * envelope header to out_buf immediately; the ciphertext and tag are
+ * produced by subsequent tagotips_seal_step() calls. The inner frame and
+ * out_buf must stay valid until the task completes.
+ *
+ * Returns the total envelope length that will be written to out_buf, or
+ * a negative error code.
+ */
+int32_t tagotips_seal_start(
+  tagotips_seal_task_t *task,
+  const tagotips_session_t *session,
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  uint8_t *out_buf, size_t out_buf_len);
+
+/**
+ * Advance a cooperative seal by at most max_blocks 16-byte plaintext
+ * blocks, bounding the time spent in one loop() iteration. The call that
+ * consumes the last plaintext also flushes the final partial block and
+ * appends the tag.
+ *
+ * Returns the number of blocks still to process (call again), 0 once the
+ * envelope is complete, or a negative error code.
+ */
+int32_t tagotips_seal_step(tagotips_seal_task_t *task, size_t max_blocks);
+
+/* -----------------------------------------------------------------------
+ * Keystream precomputation (idle-time CTR)
+ * ----------------------------------------------------------------------- */
+
+/**
+ * Precompute the CTR keystream and A0 tag block for the next envelope
+ * during idle time. method and counter must match the eventual seal;
+ * ks_buf receives up to ks_buf_len keystream bytes (capped at
+ * TAGOTIPS_MAX_INNER_FRAME) and must stay valid until the seal.
+ *
+ * Returns the number of keystream bytes cached, or a negative error
+ * code.
+ */
+int32_t tagotips_keystream_precompute(
+  tagotips_keystream_t *ks,
+  const tagotips_session_t *session,
+  uint8_t method, uint32_t counter,
+  const uint8_t device_hash[8],
+  uint8_t *ks_buf, size_t ks_buf_len);
+
+/**
+ * Seal using a precomputed keystream: only the CBC-MAC pass and an XOR
+ * remain on the critical path. If the keystream does not match the
+ * requested method/counter/device (or has been consumed, or is too
+ * short for the payload), the call transparently falls back to the full
+ * computation, so the sketch can always use this entry point. A
+ * matching keystream is wiped after use -- one precompute, one seal.
+ *
+ * Same output and return semantics as tagotips_session_seal().
+ */
+int32_t tagotips_seal_precomputed(
+  const tagotips_session_t *session,
+  tagotips_keystream_t *ks,
+  const uint8_t *inner_frame, size_t inner_len,
+  uint8_t method, uint32_t counter,
+  const uint8_t auth_hash[8], const uint8_t device_hash[8],
+  uint8_t *out_buf, size_t out_buf_len);
+
+/**
+ * Wipe a precomputed keystream without using it (e.g. at teardown or
+ * when the next counter is abandoned).
+ */
+void tagotips_keystream_destroy(tagotips_keystream_t *ks);
+
 /* -----------------------------------------------------------------------
  * Parse header (no decryption)
  * ----------------------------------------------------------------------- */
@@ -149,6 +836,40 @@ int tagotips_is_envelope(const uint8_t *data, size_t len);
 int32_t tagotips_derive_key(const char *token, const char *serial,
                             uint8_t *out_key, size_t key_len);
 
+/**
+ * Precomputed HMAC-SHA256 key state: the inner (ipad) and outer (opad)
+ * SHA-256 states after absorbing the padded key block. Initialize with
+ * tagotips_hmac_key_init(); the fields are internal.
+ */
+typedef struct {
+  tagotips_sha256_ctx inner;
+  tagotips_sha256_ctx outer;
+} tagotips_hmac_key_t;
+
+/**
+ * Precompute the HMAC pad states for a token. The "at" prefix is
+ * stripped as in tagotips_derive_key(). The state can be reused for any
+ * number of tagotips_derive_key_cached() calls, saving the key padding
+ * and two pad compressions per derivation.
+ * Returns 0 on success, or a negative error code.
+ */
+int32_t tagotips_hmac_key_init(tagotips_hmac_key_t *hmac_key, const char *token);
+
+/**
+ * Derive an encryption key for a serial using a precomputed HMAC state.
+ * Produces the same output as tagotips_derive_key() with the token the
+ * state was initialized from.
+ * Returns 0 on success, or a negative error code.
+ */
+int32_t tagotips_derive_key_cached(const tagotips_hmac_key_t *hmac_key,
+                                   const char *serial,
+                                   uint8_t *out_key, size_t key_len);
+
+/**
+ * Zero a precomputed HMAC key state.
+ */
+void tagotips_hmac_key_destroy(tagotips_hmac_key_t *hmac_key);
+
 /* -----------------------------------------------------------------------
  * Hex utilities
  * ----------------------------------------------------------------------- */
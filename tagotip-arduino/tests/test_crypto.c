@@ -133,6 +133,49 @@ void test_sha256_abc(void) {
   ASSERT_MEM_EQ(hash, expected_first8, 8, "SHA-256 'abc' (first 8 bytes via device_hash)");
 }
 
+void test_sha256_streaming_chunked(void) {
+  /* SHA-256("abc") via the streaming API, fed one byte at a time */
+  uint8_t expected[32] = {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+    0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+    0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+    0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+  };
+  const uint8_t msg[] = "abc";
+
+  tagotips_sha256_ctx ctx;
+  tagotips_sha256_init(&ctx);
+  for (size_t i = 0; i < 3; i++) {
+    tagotips_sha256_update(&ctx, msg + i, 1);
+  }
+  uint8_t digest[32];
+  tagotips_sha256_final(&ctx, digest);
+  ASSERT_MEM_EQ(digest, expected, 32, "streaming SHA-256 'abc' byte-at-a-time");
+}
+
+void test_sha256_streaming_block_boundary(void) {
+  /* Chunks that straddle the 64-byte block boundary must match a one-shot
+   * hash of the same message (verified via device hash derivation). */
+  char msg[150];
+  for (size_t i = 0; i < sizeof(msg) - 1; i++) {
+    msg[i] = (char)('a' + (i % 26));
+  }
+  msg[sizeof(msg) - 1] = '\0';
+
+  uint8_t oneshot[8];
+  tagotips_derive_device_hash(msg, oneshot);
+
+  tagotips_sha256_ctx ctx;
+  tagotips_sha256_init(&ctx);
+  tagotips_sha256_update(&ctx, (const uint8_t *)msg, 60);
+  tagotips_sha256_update(&ctx, (const uint8_t *)msg + 60, 10);
+  tagotips_sha256_update(&ctx, (const uint8_t *)msg + 70, 79);
+  uint8_t digest[32];
+  tagotips_sha256_final(&ctx, digest);
+
+  ASSERT_MEM_EQ(digest, oneshot, 8, "streaming SHA-256 across block boundary");
+}
+
 /* =========================================================================
  * Hash derivation tests (spec section 11.1)
  * ========================================================================= */
@@ -237,6 +280,82 @@ void test_round_trip(void) {
   ASSERT_TRUE(memcmp(recovered, plaintext, pt_len) == 0, "round-trip plaintext matches");
 }
 
+void test_round_trip_stride_boundaries(void) {
+  /* Lengths straddling the 16-byte block and 64-byte keystream-stride
+   * boundaries used by the CTR loop */
+  size_t lengths[] = { 1, 15, 16, 17, 48, 63, 64, 65, 80, 129 };
+
+  uint8_t auth_hash[8], device_hash[8];
+  tagotips_derive_auth_hash("atdeadbeef1234567890abcdef1234567890", auth_hash);
+  tagotips_derive_device_hash("stride-dev", device_hash);
+
+  uint8_t key[16] = { 0x5a, 0x5b, 0x5c, 0x5d, 0x5e, 0x5f, 0x60, 0x61,
+                       0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69 };
+
+  for (size_t t = 0; t < sizeof(lengths) / sizeof(lengths[0]); t++) {
+    uint8_t plaintext[129];
+    for (size_t i = 0; i < lengths[t]; i++) {
+      plaintext[i] = (uint8_t)(t * 17 + i);
+    }
+
+    uint8_t envelope[256];
+    int32_t sealed = tagotips_seal(
+      plaintext, lengths[t],
+      TAGOTIPS_METHOD_PUSH, (uint32_t)t,
+      auth_hash, device_hash, key,
+      envelope, sizeof(envelope));
+
+    char msg[64];
+    snprintf(msg, sizeof(msg), "stride length %zu seal succeeds", lengths[t]);
+    ASSERT_TRUE(sealed > 0, msg);
+
+    TagotipsHeader hdr;
+    uint8_t method;
+    uint8_t recovered[256];
+    int32_t opened = tagotips_open(
+      envelope, (size_t)sealed,
+      key, &hdr, &method, recovered, sizeof(recovered));
+
+    snprintf(msg, sizeof(msg), "stride length %zu opens", lengths[t]);
+    ASSERT_EQ(opened, (int32_t)lengths[t], msg);
+    snprintf(msg, sizeof(msg), "stride length %zu plaintext", lengths[t]);
+    ASSERT_TRUE(memcmp(recovered, plaintext, lengths[t]) == 0, msg);
+  }
+}
+
+void test_round_trip_multi_block(void) {
+  /* 333 bytes: 20 full CCM blocks plus a 13-byte tail */
+  uint8_t plaintext[333];
+  for (size_t i = 0; i < sizeof(plaintext); i++) {
+    plaintext[i] = (uint8_t)(i * 7 + 1);
+  }
+
+  uint8_t auth_hash[8], device_hash[8];
+  tagotips_derive_auth_hash("atdeadbeef1234567890abcdef1234567890", auth_hash);
+  tagotips_derive_device_hash("multi-block-dev", device_hash);
+
+  uint8_t key[16] = { 0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+                       0xa8, 0xa9, 0xaa, 0xab, 0xac, 0xad, 0xae, 0xaf };
+
+  uint8_t envelope[512];
+  int32_t sealed = tagotips_seal(
+    plaintext, sizeof(plaintext),
+    TAGOTIPS_METHOD_PUSH, 77,
+    auth_hash, device_hash, key,
+    envelope, sizeof(envelope));
+  ASSERT_EQ(sealed, (int32_t)(TAGOTIPS_HEADER_SIZE + sizeof(plaintext) + TAGOTIPS_TAG_SIZE),
+            "multi-block envelope size");
+
+  TagotipsHeader hdr;
+  uint8_t method;
+  uint8_t recovered[512];
+  int32_t opened = tagotips_open(
+    envelope, (size_t)sealed,
+    key, &hdr, &method, recovered, sizeof(recovered));
+  ASSERT_EQ(opened, (int32_t)sizeof(plaintext), "multi-block open length");
+  ASSERT_MEM_EQ(recovered, plaintext, sizeof(plaintext), "multi-block plaintext matches");
+}
+
 void test_round_trip_empty_plaintext(void) {
   uint8_t auth_hash[8], device_hash[8];
   tagotips_derive_auth_hash("atdeadbeef1234567890abcdef1234567890", auth_hash);
@@ -266,6 +385,622 @@ void test_round_trip_empty_plaintext(void) {
   ASSERT_EQ(method, TAGOTIPS_METHOD_PULL, "empty plaintext method");
 }
 
+/* =========================================================================
+ * In-place seal/open
+ * ========================================================================= */
+
+void test_seal_inplace_spec_envelope(void) {
+  uint8_t buf[64];
+  memcpy(buf + TAGOTIPS_HEADER_SIZE, SPEC_INNER_FRAME, sizeof(SPEC_INNER_FRAME));
+
+  int32_t rc = tagotips_seal_inplace(
+    buf, sizeof(buf), sizeof(SPEC_INNER_FRAME),
+    TAGOTIPS_METHOD_PUSH, SPEC_COUNTER,
+    SPEC_AUTH_HASH, SPEC_DEVICE_HASH, SPEC_KEY);
+
+  ASSERT_EQ(rc, 49, "seal_inplace returns 49 bytes");
+  ASSERT_MEM_EQ(buf, SPEC_ENVELOPE, 49, "seal_inplace envelope matches spec");
+}
+
+void test_open_inplace_spec_envelope(void) {
+  uint8_t buf[64];
+  memcpy(buf, SPEC_ENVELOPE, sizeof(SPEC_ENVELOPE));
+
+  TagotipsHeader hdr;
+  uint8_t method;
+  int32_t rc = tagotips_open_inplace(
+    buf, sizeof(SPEC_ENVELOPE), SPEC_KEY, &hdr, &method);
+
+  ASSERT_EQ(rc, 20, "open_inplace returns 20 bytes plaintext");
+  ASSERT_EQ(method, TAGOTIPS_METHOD_PUSH, "open_inplace method is PUSH");
+  ASSERT_MEM_EQ(buf + TAGOTIPS_HEADER_SIZE, SPEC_INNER_FRAME, 20,
+                "open_inplace plaintext at header offset");
+}
+
+void test_inplace_round_trip_multi_block(void) {
+  uint8_t buf[512];
+  size_t pt_len = 100;
+  for (size_t i = 0; i < pt_len; i++) {
+    buf[TAGOTIPS_HEADER_SIZE + i] = (uint8_t)(i * 3 + 5);
+  }
+  uint8_t original[100];
+  memcpy(original, buf + TAGOTIPS_HEADER_SIZE, pt_len);
+
+  uint8_t auth_hash[8], device_hash[8];
+  tagotips_derive_auth_hash("atdeadbeef1234567890abcdef1234567890", auth_hash);
+  tagotips_derive_device_hash("inplace-dev", device_hash);
+
+  uint8_t key[16] = { 0x5a, 0x5b, 0x5c, 0x5d, 0x5e, 0x5f, 0x60, 0x61,
+                       0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69 };
+
+  int32_t sealed = tagotips_seal_inplace(
+    buf, sizeof(buf), pt_len,
+    TAGOTIPS_METHOD_PUSH, 9,
+    auth_hash, device_hash, key);
+  ASSERT_EQ(sealed, (int32_t)(TAGOTIPS_HEADER_SIZE + pt_len + TAGOTIPS_TAG_SIZE),
+            "inplace round-trip envelope size");
+
+  TagotipsHeader hdr;
+  uint8_t method;
+  int32_t opened = tagotips_open_inplace(buf, (size_t)sealed, key, &hdr, &method);
+  ASSERT_EQ(opened, (int32_t)pt_len, "inplace round-trip open length");
+  ASSERT_MEM_EQ(buf + TAGOTIPS_HEADER_SIZE, original, pt_len,
+                "inplace round-trip plaintext matches");
+}
+
+void test_inplace_buffer_too_small(void) {
+  uint8_t buf[32];
+  int32_t rc = tagotips_seal_inplace(
+    buf, sizeof(buf), 20,
+    TAGOTIPS_METHOD_PUSH, 1,
+    SPEC_AUTH_HASH, SPEC_DEVICE_HASH, SPEC_KEY);
+  ASSERT_EQ(rc, TAGOTIPS_ERR_BUFFER_TOO_SMALL, "seal_inplace buffer too small");
+}
+
+void test_session_inplace_round_trip(void) {
+  tagotips_session_t session;
+  tagotips_session_init(&session, SPEC_KEY);
+
+  uint8_t buf[64];
+  memcpy(buf + TAGOTIPS_HEADER_SIZE, SPEC_INNER_FRAME, sizeof(SPEC_INNER_FRAME));
+
+  int32_t sealed = tagotips_session_seal_inplace(
+    &session, buf, sizeof(buf), sizeof(SPEC_INNER_FRAME),
+    TAGOTIPS_METHOD_PUSH, SPEC_COUNTER,
+    SPEC_AUTH_HASH, SPEC_DEVICE_HASH);
+  ASSERT_EQ(sealed, 49, "session seal_inplace returns 49 bytes");
+  ASSERT_MEM_EQ(buf, SPEC_ENVELOPE, 49, "session seal_inplace envelope matches spec");
+
+  TagotipsHeader hdr;
+  uint8_t method;
+  int32_t opened = tagotips_session_open_inplace(&session, buf, (size_t)sealed, &hdr, &method);
+  ASSERT_EQ(opened, 20, "session open_inplace length");
+  ASSERT_MEM_EQ(buf + TAGOTIPS_HEADER_SIZE, SPEC_INNER_FRAME, 20,
+                "session open_inplace plaintext matches");
+
+  tagotips_session_destroy(&session);
+}
+
+/* =========================================================================
+ * Streaming seal
+ * ========================================================================= */
+
+void test_stream_seal_spec_envelope(void) {
+  tagotips_session_t session;
+  tagotips_session_init(&session, SPEC_KEY);
+
+  tagotips_seal_stream_t stream;
+  uint8_t envelope[64];
+  int32_t rc = tagotips_seal_init(
+    &stream, &session, sizeof(SPEC_INNER_FRAME),
+    TAGOTIPS_METHOD_PUSH, SPEC_COUNTER,
+    SPEC_AUTH_HASH, SPEC_DEVICE_HASH, envelope);
+  ASSERT_EQ(rc, TAGOTIPS_OK, "seal_init returns OK");
+  ASSERT_MEM_EQ(envelope, SPEC_AAD, 21, "seal_init header matches spec");
+
+  size_t pos = TAGOTIPS_HEADER_SIZE;
+  /* Feed the 20-byte inner frame in uneven chunks: 7 + 9 + 4 */
+  int32_t n = tagotips_seal_update(&stream, SPEC_INNER_FRAME, 7,
+                                   envelope + pos, sizeof(envelope) - pos);
+  ASSERT_EQ(n, 0, "seal_update 7 bytes buffers");
+  n = tagotips_seal_update(&stream, SPEC_INNER_FRAME + 7, 9,
+                           envelope + pos, sizeof(envelope) - pos);
+  ASSERT_EQ(n, 16, "seal_update crosses block boundary");
+  pos += (size_t)n;
+  n = tagotips_seal_update(&stream, SPEC_INNER_FRAME + 16, 4,
+                           envelope + pos, sizeof(envelope) - pos);
+  ASSERT_EQ(n, 0, "seal_update tail buffers");
+
+  n = tagotips_seal_final(&stream, envelope + pos, sizeof(envelope) - pos);
+  ASSERT_EQ(n, 12, "seal_final flushes tail + tag");
+  pos += (size_t)n;
+
+  ASSERT_EQ((int)pos, 49, "streaming envelope length");
+  ASSERT_MEM_EQ(envelope, SPEC_ENVELOPE, 49, "streaming envelope matches spec");
+
+  tagotips_session_destroy(&session);
+}
+
+void test_stream_seal_single_shot_equivalence(void) {
+  uint8_t plaintext[200];
+  for (size_t i = 0; i < sizeof(plaintext); i++) {
+    plaintext[i] = (uint8_t)(i ^ 0x5c);
+  }
+
+  uint8_t auth_hash[8], device_hash[8];
+  tagotips_derive_auth_hash("atdeadbeef1234567890abcdef1234567890", auth_hash);
+  tagotips_derive_device_hash("stream-dev", device_hash);
+
+  uint8_t key[16] = { 0x10, 0x21, 0x32, 0x43, 0x54, 0x65, 0x76, 0x87,
+                       0x98, 0xa9, 0xba, 0xcb, 0xdc, 0xed, 0xfe, 0x0f };
+
+  uint8_t expected[512];
+  int32_t expected_len = tagotips_seal(
+    plaintext, sizeof(plaintext),
+    TAGOTIPS_METHOD_PUSH, 321,
+    auth_hash, device_hash, key,
+    expected, sizeof(expected));
+  ASSERT_TRUE(expected_len > 0, "stream equivalence one-shot seal succeeds");
+
+  tagotips_session_t session;
+  tagotips_session_init(&session, key);
+
+  tagotips_seal_stream_t stream;
+  uint8_t streamed[512];
+  tagotips_seal_init(&stream, &session, sizeof(plaintext),
+                     TAGOTIPS_METHOD_PUSH, 321,
+                     auth_hash, device_hash, streamed);
+
+  size_t pos = TAGOTIPS_HEADER_SIZE;
+  size_t fed = 0;
+  const size_t chunks[] = { 1, 15, 16, 17, 64, 87 };
+  for (size_t c = 0; c < 6; c++) {
+    int32_t n = tagotips_seal_update(&stream, plaintext + fed, chunks[c],
+                                     streamed + pos, sizeof(streamed) - pos);
+    ASSERT_TRUE(n >= 0, "stream equivalence update succeeds");
+    pos += (size_t)n;
+    fed += chunks[c];
+  }
+  int32_t n = tagotips_seal_final(&stream, streamed + pos, sizeof(streamed) - pos);
+  ASSERT_TRUE(n >= 0, "stream equivalence final succeeds");
+  pos += (size_t)n;
+
+  ASSERT_EQ((int32_t)pos, expected_len, "stream equivalence envelope length");
+  ASSERT_MEM_EQ(streamed, expected, (size_t)expected_len,
+                "stream equivalence envelope bytes");
+
+  tagotips_session_destroy(&session);
+}
+
+void test_stream_seal_length_mismatch(void) {
+  tagotips_session_t session;
+  tagotips_session_init(&session, SPEC_KEY);
+
+  tagotips_seal_stream_t stream;
+  uint8_t header[TAGOTIPS_HEADER_SIZE];
+  tagotips_seal_init(&stream, &session, 10,
+                     TAGOTIPS_METHOD_PUSH, 1,
+                     SPEC_AUTH_HASH, SPEC_DEVICE_HASH, header);
+
+  uint8_t out[64];
+  /* Feeding more than declared fails */
+  int32_t rc = tagotips_seal_update(&stream, SPEC_INNER_FRAME, 11, out, sizeof(out));
+  ASSERT_EQ(rc, TAGOTIPS_ERR_LENGTH_MISMATCH, "seal_update over-feed rejected");
+
+  /* Finalizing before the declared length is fed fails */
+  tagotips_seal_update(&stream, SPEC_INNER_FRAME, 5, out, sizeof(out));
+  rc = tagotips_seal_final(&stream, out, sizeof(out));
+  ASSERT_EQ(rc, TAGOTIPS_ERR_LENGTH_MISMATCH, "seal_final under-feed rejected");
+
+  tagotips_session_destroy(&session);
+}
+
+/* =========================================================================
+ * Session API
+ * ========================================================================= */
+
+void test_session_seal_spec_envelope(void) {
+  tagotips_session_t session;
+  int32_t rc = tagotips_session_init(&session, SPEC_KEY);
+  ASSERT_EQ(rc, TAGOTIPS_OK, "session_init returns OK");
+
+  uint8_t out[64];
+  rc = tagotips_session_seal(
+    &session,
+    SPEC_INNER_FRAME, sizeof(SPEC_INNER_FRAME),
+    TAGOTIPS_METHOD_PUSH, SPEC_COUNTER,
+    SPEC_AUTH_HASH, SPEC_DEVICE_HASH,
+    out, sizeof(out));
+
+  ASSERT_EQ(rc, 49, "session seal returns 49 bytes");
+  ASSERT_MEM_EQ(out, SPEC_ENVELOPE, 49, "session seal envelope matches spec");
+
+  tagotips_session_destroy(&session);
+}
+
+void test_session_open_spec_envelope(void) {
+  tagotips_session_t session;
+  tagotips_session_init(&session, SPEC_KEY);
+
+  TagotipsHeader hdr;
+  uint8_t method;
+  uint8_t inner[64];
+  int32_t rc = tagotips_session_open(
+    &session,
+    SPEC_ENVELOPE, sizeof(SPEC_ENVELOPE),
+    &hdr, &method, inner, sizeof(inner));
+
+  ASSERT_EQ(rc, 20, "session open returns 20 bytes plaintext");
+  ASSERT_EQ(method, TAGOTIPS_METHOD_PUSH, "session open method is PUSH");
+  ASSERT_MEM_EQ(inner, SPEC_INNER_FRAME, 20, "session open plaintext matches spec");
+
+  tagotips_session_destroy(&session);
+}
+
+void test_session_reuse_across_counters(void) {
+  tagotips_session_t session;
+  tagotips_session_init(&session, SPEC_KEY);
+
+  const uint8_t plaintext[] = "repeated uplink payload";
+  size_t pt_len = sizeof(plaintext) - 1;
+
+  for (uint32_t counter = 1; counter <= 5; counter++) {
+    uint8_t envelope[128];
+    int32_t sealed = tagotips_session_seal(
+      &session, plaintext, pt_len,
+      TAGOTIPS_METHOD_PUSH, counter,
+      SPEC_AUTH_HASH, SPEC_DEVICE_HASH,
+      envelope, sizeof(envelope));
+    ASSERT_TRUE(sealed > 0, "session reuse seal succeeds");
+
+    TagotipsHeader hdr;
+    uint8_t method;
+    uint8_t recovered[128];
+    int32_t opened = tagotips_session_open(
+      &session, envelope, (size_t)sealed,
+      &hdr, &method, recovered, sizeof(recovered));
+    ASSERT_EQ(opened, (int32_t)pt_len, "session reuse open length");
+    ASSERT_EQ((int)hdr.counter, (int)counter, "session reuse counter");
+    ASSERT_TRUE(memcmp(recovered, plaintext, pt_len) == 0, "session reuse plaintext matches");
+  }
+
+  tagotips_session_destroy(&session);
+}
+
+void test_session_destroy_zeroes_schedule(void) {
+  tagotips_session_t session;
+  tagotips_session_init(&session, SPEC_KEY);
+  tagotips_session_destroy(&session);
+
+  int all_zero = 1;
+  for (size_t i = 0; i < sizeof(session.round_keys); i++) {
+    if (session.round_keys[i] != 0) { all_zero = 0; break; }
+  }
+  ASSERT_TRUE(all_zero, "session_destroy zeroes round keys");
+}
+
+void test_session_null_pointers(void) {
+  tagotips_session_t session;
+  ASSERT_EQ(tagotips_session_init(NULL, SPEC_KEY), TAGOTIPS_ERR_NULL_PTR,
+            "session_init null session");
+  ASSERT_EQ(tagotips_session_init(&session, NULL), TAGOTIPS_ERR_NULL_PTR,
+            "session_init null key");
+
+  uint8_t out[64];
+  ASSERT_EQ(tagotips_session_seal(
+              NULL, SPEC_INNER_FRAME, sizeof(SPEC_INNER_FRAME),
+              TAGOTIPS_METHOD_PUSH, SPEC_COUNTER,
+              SPEC_AUTH_HASH, SPEC_DEVICE_HASH, out, sizeof(out)),
+            TAGOTIPS_ERR_NULL_PTR, "session_seal null session");
+
+  TagotipsHeader hdr;
+  uint8_t method;
+  uint8_t inner[64];
+  ASSERT_EQ(tagotips_session_open(
+              NULL, SPEC_ENVELOPE, sizeof(SPEC_ENVELOPE),
+              &hdr, &method, inner, sizeof(inner)),
+            TAGOTIPS_ERR_NULL_PTR, "session_open null session");
+}
+
+/* =========================================================================
+ * Truncated tag cipher (CCM-4)
+ * ========================================================================= */
+
+/* SPEC inputs sealed with cipher 5 (AES-128-CCM, 4-byte tag). The same
+ * vector is asserted in tagotip-secure's envelope tests, so the C and
+ * Rust implementations are pinned to identical bytes. */
+static const uint8_t SPEC_ENVELOPE_CCM4[45] = {
+  0xa0, 0x00, 0x00, 0x00, 0x2a, 0x4d, 0xee, 0xdd,
+  0x7b, 0xab, 0x88, 0x17, 0xec, 0xab, 0x77, 0x88,
+  0xd2, 0x2e, 0xb7, 0x37, 0x2f, 0x26, 0x9b, 0x04,
+  0x1e, 0x89, 0x9c, 0x59, 0xc8, 0x5b, 0x12, 0xf5,
+  0x4d, 0x34, 0x4a, 0xe9, 0x4a, 0xb5, 0x89, 0x01,
+  0x9a, 0x1b, 0xf5, 0x06, 0xf0
+};
+
+void test_ccm4_seal_spec_envelope(void) {
+  uint8_t out[64];
+  int32_t rc = tagotips_seal_cipher(
+    SPEC_INNER_FRAME, sizeof(SPEC_INNER_FRAME),
+    TAGOTIPS_CIPHER_AES128_CCM_4, TAGOTIPS_METHOD_PUSH, SPEC_COUNTER,
+    SPEC_AUTH_HASH, SPEC_DEVICE_HASH, SPEC_KEY,
+    out, sizeof(out));
+
+  ASSERT_EQ(rc, 45, "CCM-4 seal returns 45 bytes (4 fewer than CCM-8)");
+  ASSERT_EQ(out[0], 0xa0, "CCM-4 flags byte carries cipher code 5");
+  ASSERT_MEM_EQ(out, SPEC_ENVELOPE_CCM4, 45, "CCM-4 envelope matches vector");
+}
+
+void test_ccm4_open_detects_cipher(void) {
+  TagotipsHeader hdr;
+  uint8_t method;
+  uint8_t inner[64];
+  int32_t rc = tagotips_open(
+    SPEC_ENVELOPE_CCM4, sizeof(SPEC_ENVELOPE_CCM4),
+    SPEC_KEY, &hdr, &method, inner, sizeof(inner));
+
+  ASSERT_EQ(rc, 20, "CCM-4 open returns 20 bytes plaintext");
+  ASSERT_EQ(method, TAGOTIPS_METHOD_PUSH, "CCM-4 open method is PUSH");
+  ASSERT_MEM_EQ(inner, SPEC_INNER_FRAME, 20, "CCM-4 open plaintext matches spec");
+}
+
+void test_ccm4_session_seal_matches(void) {
+  tagotips_session_t session;
+  tagotips_session_init(&session, SPEC_KEY);
+
+  uint8_t out[64];
+  int32_t rc = tagotips_session_seal_cipher(
+    &session,
+    SPEC_INNER_FRAME, sizeof(SPEC_INNER_FRAME),
+    TAGOTIPS_CIPHER_AES128_CCM_4, TAGOTIPS_METHOD_PUSH, SPEC_COUNTER,
+    SPEC_AUTH_HASH, SPEC_DEVICE_HASH,
+    out, sizeof(out));
+
+  ASSERT_EQ(rc, 45, "session CCM-4 seal returns 45 bytes");
+  ASSERT_MEM_EQ(out, SPEC_ENVELOPE_CCM4, 45, "session CCM-4 envelope matches vector");
+
+  tagotips_session_destroy(&session);
+}
+
+void test_ccm4_tampered_envelope_fails(void) {
+  TagotipsHeader hdr;
+  uint8_t method;
+  uint8_t inner[64];
+  uint8_t tampered[45];
+
+  /* Flip a bit in the truncated tag */
+  memcpy(tampered, SPEC_ENVELOPE_CCM4, 45);
+  tampered[44] ^= 0x01;
+  int32_t rc = tagotips_open(tampered, 45, SPEC_KEY, &hdr, &method, inner, sizeof(inner));
+  ASSERT_EQ(rc, TAGOTIPS_ERR_DECRYPTION_FAILED, "CCM-4 tampered tag rejected");
+
+  /* Rewriting the cipher code back to CCM-8 must not authenticate either:
+   * the flags byte is bound through both the AAD and the nonce */
+  memcpy(tampered, SPEC_ENVELOPE_CCM4, 45);
+  tampered[0] = 0x00;
+  rc = tagotips_open(tampered, 45, SPEC_KEY, &hdr, &method, inner, sizeof(inner));
+  ASSERT_EQ(rc, TAGOTIPS_ERR_DECRYPTION_FAILED, "cipher-code downgrade rejected");
+}
+
+void test_seal_cipher_rejects_unsupported(void) {
+  uint8_t out[64];
+
+  /* Codes 1-4 are server-side suites this library does not implement */
+  int32_t rc = tagotips_seal_cipher(
+    SPEC_INNER_FRAME, sizeof(SPEC_INNER_FRAME),
+    1, TAGOTIPS_METHOD_PUSH, SPEC_COUNTER,
+    SPEC_AUTH_HASH, SPEC_DEVICE_HASH, SPEC_KEY,
+    out, sizeof(out));
+  ASSERT_EQ(rc, TAGOTIPS_ERR_UNSUPPORTED_CIPHER, "GCM cipher code rejected");
+
+  rc = tagotips_seal_cipher(
+    SPEC_INNER_FRAME, sizeof(SPEC_INNER_FRAME),
+    6, TAGOTIPS_METHOD_PUSH, SPEC_COUNTER,
+    SPEC_AUTH_HASH, SPEC_DEVICE_HASH, SPEC_KEY,
+    out, sizeof(out));
+  ASSERT_EQ(rc, TAGOTIPS_ERR_UNSUPPORTED_CIPHER, "out-of-range cipher code rejected");
+}
+
+/* =========================================================================
+ * Workspace API
+ * ========================================================================= */
+
+void test_workspace_seal_open_spec_envelope(void) {
+  static tagotips_workspace_t ws;
+
+  uint8_t out[64];
+  int32_t rc = tagotips_workspace_seal(
+    &ws,
+    SPEC_INNER_FRAME, sizeof(SPEC_INNER_FRAME),
+    TAGOTIPS_METHOD_PUSH, SPEC_COUNTER,
+    SPEC_AUTH_HASH, SPEC_DEVICE_HASH,
+    SPEC_KEY, out, sizeof(out));
+
+  ASSERT_EQ(rc, 49, "workspace seal returns 49 bytes");
+  ASSERT_MEM_EQ(out, SPEC_ENVELOPE, 49, "workspace seal envelope matches spec");
+
+  TagotipsHeader hdr;
+  uint8_t method;
+  uint8_t inner[64];
+  rc = tagotips_workspace_open(
+    &ws,
+    SPEC_ENVELOPE, sizeof(SPEC_ENVELOPE),
+    SPEC_KEY, &hdr, &method, inner, sizeof(inner));
+
+  ASSERT_EQ(rc, 20, "workspace open returns 20 bytes plaintext");
+  ASSERT_MEM_EQ(inner, SPEC_INNER_FRAME, 20, "workspace open plaintext matches spec");
+
+  /* The schedule is wiped after each call, not just at destroy */
+  int all_zero = 1;
+  for (size_t i = 0; i < sizeof(ws.round_keys); i++) {
+    if (ws.round_keys[i] != 0) { all_zero = 0; break; }
+  }
+  ASSERT_TRUE(all_zero, "workspace round keys wiped after call");
+
+  tagotips_workspace_destroy(&ws);
+}
+
+void test_workspace_derive_key_matches(void) {
+  static tagotips_workspace_t ws;
+
+  uint8_t key[32], direct[32];
+  int32_t rc = tagotips_workspace_derive_key(&ws, SPEC_TOKEN, SPEC_SERIAL, key, 32);
+  ASSERT_EQ(rc, TAGOTIPS_OK, "workspace derive_key returns OK");
+  tagotips_derive_key(SPEC_TOKEN, SPEC_SERIAL, direct, 32);
+  ASSERT_MEM_EQ(key, direct, 32, "workspace derive_key matches derive_key");
+
+  tagotips_workspace_destroy(&ws);
+}
+
+void test_workspace_null_pointers(void) {
+  tagotips_workspace_t ws;
+  uint8_t out[64];
+
+  ASSERT_EQ(tagotips_workspace_seal(
+              NULL, SPEC_INNER_FRAME, sizeof(SPEC_INNER_FRAME),
+              TAGOTIPS_METHOD_PUSH, SPEC_COUNTER,
+              SPEC_AUTH_HASH, SPEC_DEVICE_HASH,
+              SPEC_KEY, out, sizeof(out)),
+            TAGOTIPS_ERR_NULL_PTR, "workspace_seal null workspace");
+
+  TagotipsHeader hdr;
+  uint8_t method;
+  uint8_t inner[64];
+  ASSERT_EQ(tagotips_workspace_open(
+              NULL, SPEC_ENVELOPE, sizeof(SPEC_ENVELOPE),
+              SPEC_KEY, &hdr, &method, inner, sizeof(inner)),
+            TAGOTIPS_ERR_NULL_PTR, "workspace_open null workspace");
+
+  uint8_t key[16];
+  ASSERT_EQ(tagotips_workspace_derive_key(NULL, SPEC_TOKEN, SPEC_SERIAL, key, 16),
+            TAGOTIPS_ERR_NULL_PTR, "workspace_derive_key null workspace");
+  ASSERT_EQ(tagotips_workspace_derive_key(&ws, NULL, SPEC_SERIAL, key, 16),
+            TAGOTIPS_ERR_NULL_PTR, "workspace_derive_key null token");
+}
+
+/* =========================================================================
+ * Counter manager
+ * ========================================================================= */
+
+static uint32_t counter_store_log[16];
+static size_t counter_store_calls;
+static int counter_store_fail;
+
+static int32_t counter_test_store(uint32_t value, void *user) {
+  (void)user;
+  if (counter_store_fail) return -1;
+  if (counter_store_calls < 16) {
+    counter_store_log[counter_store_calls] = value;
+  }
+  counter_store_calls++;
+  return TAGOTIPS_OK;
+}
+
+static void counter_test_reset(void) {
+  memset(counter_store_log, 0, sizeof(counter_store_log));
+  counter_store_calls = 0;
+  counter_store_fail = 0;
+}
+
+void test_counter_commit_interval(void) {
+  counter_test_reset();
+
+  tagotips_counter_t counter;
+  int32_t rc = tagotips_counter_init(&counter, 0, 8, counter_test_store, NULL);
+  ASSERT_EQ(rc, TAGOTIPS_OK, "counter_init returns OK");
+
+  for (uint32_t i = 0; i < 20; i++) {
+    uint32_t value;
+    rc = tagotips_counter_next(&counter, &value);
+    ASSERT_EQ(rc, TAGOTIPS_OK, "counter_next returns OK");
+    ASSERT_EQ((int)value, (int)i, "counter values are sequential");
+  }
+
+  /* 20 draws at step 8: reservations at 8, 16, 24 -- three flash writes */
+  ASSERT_EQ((int)counter_store_calls, 3, "one store per 8 increments");
+  ASSERT_EQ((int)counter_store_log[0], 8, "first reservation bound");
+  ASSERT_EQ((int)counter_store_log[2], 24, "third reservation bound");
+}
+
+void test_counter_boot_resume(void) {
+  counter_test_reset();
+
+  /* Reboot after the 24 reservation above: resume at the stored bound */
+  tagotips_counter_t counter;
+  tagotips_counter_init(&counter, 24, 8, counter_test_store, NULL);
+
+  uint32_t value;
+  int32_t rc = tagotips_counter_next(&counter, &value);
+  ASSERT_EQ(rc, TAGOTIPS_OK, "counter_next after resume returns OK");
+  ASSERT_EQ((int)value, 24, "resume hands out the stored bound first");
+  ASSERT_EQ((int)counter_store_log[0], 32, "resume reserves the next window");
+}
+
+void test_counter_flush_and_store_failure(void) {
+  counter_test_reset();
+
+  tagotips_counter_t counter;
+  tagotips_counter_init(&counter, 0, 4, counter_test_store, NULL);
+
+  uint32_t value;
+  tagotips_counter_next(&counter, &value);
+  tagotips_counter_next(&counter, &value);
+
+  /* Flush closes the open window at the exact position */
+  int32_t rc = tagotips_counter_flush(&counter);
+  ASSERT_EQ(rc, TAGOTIPS_OK, "counter_flush returns OK");
+  ASSERT_EQ((int)counter_store_log[counter_store_calls - 1], 2,
+            "flush persists the exact position");
+
+  /* A failed store must not advance the counter */
+  counter_store_fail = 1;
+  rc = tagotips_counter_next(&counter, &value);
+  ASSERT_EQ(rc, TAGOTIPS_ERR_STORAGE_FAILED, "failed store reported");
+
+  counter_store_fail = 0;
+  rc = tagotips_counter_next(&counter, &value);
+  ASSERT_EQ(rc, TAGOTIPS_OK, "counter recovers after store failure");
+  ASSERT_EQ((int)value, 2, "no value skipped by the failed store");
+
+  /* Argument checks */
+  ASSERT_EQ(tagotips_counter_init(&counter, 0, 0, counter_test_store, NULL),
+            TAGOTIPS_ERR_INVALID_ARG, "counter_init zero step rejected");
+  ASSERT_EQ(tagotips_counter_init(&counter, 0, 4, NULL, NULL),
+            TAGOTIPS_ERR_NULL_PTR, "counter_init null store rejected");
+}
+
+void test_counter_seal_round_trip(void) {
+  counter_test_reset();
+
+  tagotips_session_t session;
+  tagotips_session_init(&session, SPEC_KEY);
+
+  tagotips_counter_t counter;
+  tagotips_counter_init(&counter, 100, 5, counter_test_store, NULL);
+
+  for (uint32_t expected = 100; expected < 102; expected++) {
+    uint8_t envelope[64];
+    int32_t sealed = tagotips_counter_seal(
+      &counter, &session,
+      SPEC_INNER_FRAME, sizeof(SPEC_INNER_FRAME),
+      TAGOTIPS_METHOD_PUSH,
+      SPEC_AUTH_HASH, SPEC_DEVICE_HASH,
+      envelope, sizeof(envelope));
+    ASSERT_EQ(sealed, 49, "counter_seal returns envelope length");
+
+    TagotipsHeader hdr;
+    uint8_t method;
+    uint8_t inner[64];
+    int32_t opened = tagotips_session_open(
+      &session, envelope, (size_t)sealed,
+      &hdr, &method, inner, sizeof(inner));
+    ASSERT_EQ(opened, 20, "counter_seal envelope opens");
+    ASSERT_EQ((int)hdr.counter, (int)expected, "counter_seal uses managed counter");
+  }
+
+  tagotips_session_destroy(&session);
+}
+
 /* =========================================================================
  * tagotips_parse_header
  * ========================================================================= */
@@ -561,6 +1296,152 @@ void test_derive_key_seal_open_round_trip(void) {
   ASSERT_TRUE(memcmp(recovered, plaintext, pt_len) == 0, "derive_key round-trip plaintext matches");
 }
 
+void test_derive_key_cached_matches_uncached(void) {
+  tagotips_hmac_key_t hmac_key;
+  int32_t rc = tagotips_hmac_key_init(&hmac_key, SPEC_TOKEN);
+  ASSERT_EQ(rc, TAGOTIPS_OK, "hmac_key_init returns OK");
+
+  uint8_t cached[32];
+  rc = tagotips_derive_key_cached(&hmac_key, SPEC_SERIAL, cached, 32);
+  ASSERT_EQ(rc, TAGOTIPS_OK, "derive_key_cached returns OK");
+  ASSERT_MEM_EQ(cached, SPEC_DERIVED_KEY, 32, "derive_key_cached matches spec vector");
+
+  tagotips_hmac_key_destroy(&hmac_key);
+}
+
+void test_derive_key_cached_many_serials(void) {
+  tagotips_hmac_key_t hmac_key;
+  tagotips_hmac_key_init(&hmac_key, SPEC_TOKEN);
+
+  const char *serials[] = { "sensor-01", "sensor-02", "gw-7f", "x" };
+  for (size_t i = 0; i < sizeof(serials) / sizeof(serials[0]); i++) {
+    uint8_t cached[16], direct[16];
+    tagotips_derive_key_cached(&hmac_key, serials[i], cached, 16);
+    tagotips_derive_key(SPEC_TOKEN, serials[i], direct, 16);
+    ASSERT_MEM_EQ(cached, direct, 16, "derive_key_cached matches derive_key per serial");
+  }
+
+  tagotips_hmac_key_destroy(&hmac_key);
+}
+
+void test_derive_key_cached_null_pointers(void) {
+  tagotips_hmac_key_t hmac_key;
+  uint8_t key[16];
+  ASSERT_EQ(tagotips_hmac_key_init(NULL, SPEC_TOKEN), TAGOTIPS_ERR_NULL_PTR,
+            "hmac_key_init null state");
+  ASSERT_EQ(tagotips_hmac_key_init(&hmac_key, NULL), TAGOTIPS_ERR_NULL_PTR,
+            "hmac_key_init null token");
+  tagotips_hmac_key_init(&hmac_key, SPEC_TOKEN);
+  ASSERT_EQ(tagotips_derive_key_cached(NULL, SPEC_SERIAL, key, 16),
+            TAGOTIPS_ERR_NULL_PTR, "derive_key_cached null state");
+  ASSERT_EQ(tagotips_derive_key_cached(&hmac_key, SPEC_SERIAL, key, 33),
+            TAGOTIPS_ERR_BUFFER_TOO_SMALL, "derive_key_cached bad length");
+}
+
+/* =========================================================================
+ * identity tests
+ * ========================================================================= */
+
+void test_identity_init_caches_hashes(void) {
+  tagotips_identity_t identity;
+  int32_t rc = tagotips_identity_init(&identity, SPEC_TOKEN, SPEC_SERIAL);
+  ASSERT_EQ(rc, TAGOTIPS_OK, "identity_init returns OK");
+  ASSERT_MEM_EQ(identity.auth_hash, SPEC_AUTH_HASH, 8, "identity caches auth hash");
+  ASSERT_MEM_EQ(identity.device_hash, SPEC_DEVICE_HASH, 8, "identity caches device hash");
+  tagotips_identity_destroy(&identity);
+}
+
+void test_identity_seal_matches_oneshot(void) {
+  tagotips_identity_t identity;
+  tagotips_identity_init(&identity, SPEC_TOKEN, SPEC_SERIAL);
+
+  const uint8_t plaintext[] = "sensor-01|[temp:=32]";
+  size_t pt_len = sizeof(plaintext) - 1;
+
+  uint8_t from_identity[128];
+  int32_t sealed = tagotips_identity_seal(
+    &identity, plaintext, pt_len,
+    TAGOTIPS_METHOD_PUSH, 7,
+    from_identity, sizeof(from_identity));
+  ASSERT_TRUE(sealed > 0, "identity seal succeeds");
+
+  uint8_t key[16];
+  tagotips_derive_key(SPEC_TOKEN, SPEC_SERIAL, key, 16);
+  uint8_t from_oneshot[128];
+  int32_t expected = tagotips_seal(
+    plaintext, pt_len,
+    TAGOTIPS_METHOD_PUSH, 7,
+    SPEC_AUTH_HASH, SPEC_DEVICE_HASH, key,
+    from_oneshot, sizeof(from_oneshot));
+  ASSERT_EQ(sealed, expected, "identity seal length matches one-shot");
+  ASSERT_MEM_EQ(from_identity, from_oneshot, (size_t)sealed,
+                "identity seal envelope matches one-shot");
+
+  tagotips_identity_destroy(&identity);
+}
+
+void test_identity_round_trip(void) {
+  tagotips_identity_t identity;
+  tagotips_identity_init(&identity, SPEC_TOKEN, SPEC_SERIAL);
+
+  const uint8_t plaintext[] = "sensor-01|[hum:=55.2#%]";
+  size_t pt_len = sizeof(plaintext) - 1;
+
+  uint8_t envelope[128];
+  int32_t sealed = tagotips_identity_seal(
+    &identity, plaintext, pt_len,
+    TAGOTIPS_METHOD_PUSH, 42,
+    envelope, sizeof(envelope));
+  ASSERT_TRUE(sealed > 0, "identity round-trip seal succeeds");
+
+  TagotipsHeader hdr;
+  uint8_t method;
+  uint8_t recovered[128];
+  int32_t opened = tagotips_identity_open(
+    &identity, envelope, (size_t)sealed,
+    &hdr, &method, recovered, sizeof(recovered));
+  ASSERT_EQ(opened, (int32_t)pt_len, "identity round-trip open length");
+  ASSERT_EQ((int)hdr.counter, 42, "identity round-trip counter");
+  ASSERT_TRUE(memcmp(recovered, plaintext, pt_len) == 0,
+              "identity round-trip plaintext matches");
+
+  tagotips_identity_destroy(&identity);
+}
+
+void test_identity_destroy_zeroes_state(void) {
+  tagotips_identity_t identity;
+  tagotips_identity_init(&identity, SPEC_TOKEN, SPEC_SERIAL);
+  tagotips_identity_destroy(&identity);
+
+  int all_zero = 1;
+  const uint8_t *bytes = (const uint8_t *)&identity;
+  for (size_t i = 0; i < sizeof(identity); i++) {
+    if (bytes[i] != 0) { all_zero = 0; break; }
+  }
+  ASSERT_TRUE(all_zero, "identity_destroy zeroes cached credentials");
+}
+
+void test_identity_null_pointers(void) {
+  tagotips_identity_t identity;
+  ASSERT_EQ(tagotips_identity_init(NULL, SPEC_TOKEN, SPEC_SERIAL),
+            TAGOTIPS_ERR_NULL_PTR, "identity_init null identity");
+  ASSERT_EQ(tagotips_identity_init(&identity, NULL, SPEC_SERIAL),
+            TAGOTIPS_ERR_NULL_PTR, "identity_init null token");
+  ASSERT_EQ(tagotips_identity_init(&identity, SPEC_TOKEN, NULL),
+            TAGOTIPS_ERR_NULL_PTR, "identity_init null serial");
+
+  uint8_t buf[64];
+  ASSERT_EQ(tagotips_identity_seal(
+              NULL, buf, 4, TAGOTIPS_METHOD_PUSH, 1, buf, sizeof(buf)),
+            TAGOTIPS_ERR_NULL_PTR, "identity_seal null identity");
+
+  TagotipsHeader hdr;
+  uint8_t method;
+  ASSERT_EQ(tagotips_identity_open(
+              NULL, buf, sizeof(buf), &hdr, &method, buf, sizeof(buf)),
+            TAGOTIPS_ERR_NULL_PTR, "identity_open null identity");
+}
+
 /* =========================================================================
  * hex utility tests
  * ========================================================================= */
@@ -710,6 +1591,503 @@ void test_all_methods_round_trip(void) {
   }
 }
 
+/* =========================================================================
+ * Cooperative seal
+ * ========================================================================= */
+
+void test_coop_seal_matches_oneshot(void) {
+  uint8_t plaintext[333];
+  for (size_t i = 0; i < sizeof(plaintext); i++) {
+    plaintext[i] = (uint8_t)(i * 13 + 5);
+  }
+
+  uint8_t auth_hash[8], device_hash[8];
+  tagotips_derive_auth_hash("atdeadbeef1234567890abcdef1234567890", auth_hash);
+  tagotips_derive_device_hash("coop-dev", device_hash);
+  uint8_t key[16] = { 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+                       0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30 };
+
+  uint8_t expected[512];
+  int32_t expected_len = tagotips_seal(
+    plaintext, sizeof(plaintext),
+    TAGOTIPS_METHOD_PUSH, 777,
+    auth_hash, device_hash, key,
+    expected, sizeof(expected));
+  ASSERT_TRUE(expected_len > 0, "coop reference seal succeeds");
+
+  tagotips_session_t session;
+  tagotips_session_init(&session, key);
+
+  uint8_t envelope[512];
+  tagotips_seal_task_t task;
+  int32_t total = tagotips_seal_start(
+    &task, &session, plaintext, sizeof(plaintext),
+    TAGOTIPS_METHOD_PUSH, 777, auth_hash, device_hash,
+    envelope, sizeof(envelope));
+  ASSERT_EQ(total, expected_len, "coop start returns envelope length");
+
+  /* Two plaintext blocks per step; remaining must strictly decrease */
+  int32_t remaining = (int32_t)(sizeof(plaintext) + 15) / 16 + 1;
+  int steps = 0;
+  for (;;) {
+    int32_t rc = tagotips_seal_step(&task, 2);
+    ASSERT_TRUE(rc >= 0, "coop step succeeds");
+    if (rc == 0) break;
+    ASSERT_TRUE(rc < remaining, "coop step progress decreases");
+    remaining = rc;
+    steps++;
+    ASSERT_TRUE(steps < 64, "coop seal terminates");
+  }
+
+  ASSERT_TRUE(memcmp(envelope, expected, (size_t)expected_len) == 0,
+              "coop envelope matches one-shot seal");
+  ASSERT_EQ(tagotips_seal_step(&task, 2), 0, "coop step after done is a no-op");
+
+  tagotips_session_destroy(&session);
+}
+
+void test_coop_seal_argument_checks(void) {
+  uint8_t key[16] = { 0 };
+  uint8_t auth_hash[8] = { 0 }, device_hash[8] = { 0 };
+  uint8_t plaintext[32] = { 0 };
+  uint8_t small[16];
+
+  tagotips_session_t session;
+  tagotips_session_init(&session, key);
+
+  tagotips_seal_task_t task;
+  ASSERT_EQ(tagotips_seal_start(&task, &session, plaintext, sizeof(plaintext),
+                                TAGOTIPS_METHOD_PUSH, 1, auth_hash, device_hash,
+                                small, sizeof(small)),
+            TAGOTIPS_ERR_BUFFER_TOO_SMALL, "coop start rejects short buffer");
+
+  uint8_t envelope[128];
+  ASSERT_TRUE(tagotips_seal_start(&task, &session, plaintext, sizeof(plaintext),
+                                  TAGOTIPS_METHOD_PUSH, 1, auth_hash, device_hash,
+                                  envelope, sizeof(envelope)) > 0,
+              "coop start succeeds");
+  ASSERT_EQ(tagotips_seal_step(&task, 0), TAGOTIPS_ERR_INVALID_ARG,
+            "coop step rejects zero block budget");
+  ASSERT_EQ(tagotips_seal_step(NULL, 1), TAGOTIPS_ERR_NULL_PTR,
+            "coop step rejects NULL task");
+
+  tagotips_session_destroy(&session);
+}
+
+/* =========================================================================
+ * Keystream precomputation
+ * ========================================================================= */
+
+void test_keystream_precomputed_matches_oneshot(void) {
+  uint8_t plaintext[100];
+  for (size_t i = 0; i < sizeof(plaintext); i++) {
+    plaintext[i] = (uint8_t)(i ^ 0x5a);
+  }
+
+  uint8_t auth_hash[8], device_hash[8];
+  tagotips_derive_auth_hash("atdeadbeef1234567890abcdef1234567890", auth_hash);
+  tagotips_derive_device_hash("ks-dev", device_hash);
+  uint8_t key[16] = { 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+                       0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f, 0x50 };
+
+  uint8_t expected[256];
+  int32_t expected_len = tagotips_seal(
+    plaintext, sizeof(plaintext), TAGOTIPS_METHOD_PUSH, 31337,
+    auth_hash, device_hash, key, expected, sizeof(expected));
+  ASSERT_TRUE(expected_len > 0, "keystream reference seal succeeds");
+
+  tagotips_session_t session;
+  tagotips_session_init(&session, key);
+
+  tagotips_keystream_t ks;
+  uint8_t ks_buf[128];
+  int32_t cached = tagotips_keystream_precompute(
+    &ks, &session, TAGOTIPS_METHOD_PUSH, 31337, device_hash,
+    ks_buf, sizeof(ks_buf));
+  ASSERT_EQ(cached, (int32_t)sizeof(ks_buf), "precompute fills buffer");
+
+  uint8_t envelope[256];
+  int32_t sealed = tagotips_seal_precomputed(
+    &session, &ks, plaintext, sizeof(plaintext),
+    TAGOTIPS_METHOD_PUSH, 31337, auth_hash, device_hash,
+    envelope, sizeof(envelope));
+  ASSERT_EQ(sealed, expected_len, "precomputed seal length");
+  ASSERT_TRUE(memcmp(envelope, expected, (size_t)expected_len) == 0,
+              "precomputed seal matches one-shot");
+  ASSERT_EQ((int)ks.valid, 0, "keystream consumed after seal");
+
+  /* Consumed keystream: the same call falls back and still seals right */
+  memset(envelope, 0, sizeof(envelope));
+  sealed = tagotips_seal_precomputed(
+    &session, &ks, plaintext, sizeof(plaintext),
+    TAGOTIPS_METHOD_PUSH, 31337, auth_hash, device_hash,
+    envelope, sizeof(envelope));
+  ASSERT_EQ(sealed, expected_len, "fallback seal length");
+  ASSERT_TRUE(memcmp(envelope, expected, (size_t)expected_len) == 0,
+              "fallback seal matches one-shot");
+
+  tagotips_session_destroy(&session);
+}
+
+void test_keystream_mismatch_falls_back(void) {
+  uint8_t plaintext[40];
+  memset(plaintext, 0x77, sizeof(plaintext));
+
+  uint8_t auth_hash[8], device_hash[8];
+  tagotips_derive_auth_hash("atdeadbeef1234567890abcdef1234567890", auth_hash);
+  tagotips_derive_device_hash("ks-dev-2", device_hash);
+  uint8_t key[16] = { 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+                       0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70 };
+
+  tagotips_session_t session;
+  tagotips_session_init(&session, key);
+
+  /* Precompute for counter 5, then seal counter 6 */
+  tagotips_keystream_t ks;
+  uint8_t ks_buf[64];
+  tagotips_keystream_precompute(&ks, &session, TAGOTIPS_METHOD_PUSH, 5,
+                                device_hash, ks_buf, sizeof(ks_buf));
+
+  uint8_t expected[128], envelope[128];
+  int32_t expected_len = tagotips_seal(
+    plaintext, sizeof(plaintext), TAGOTIPS_METHOD_PUSH, 6,
+    auth_hash, device_hash, key, expected, sizeof(expected));
+
+  int32_t sealed = tagotips_seal_precomputed(
+    &session, &ks, plaintext, sizeof(plaintext),
+    TAGOTIPS_METHOD_PUSH, 6, auth_hash, device_hash,
+    envelope, sizeof(envelope));
+  ASSERT_EQ(sealed, expected_len, "mismatched counter falls back");
+  ASSERT_TRUE(memcmp(envelope, expected, (size_t)expected_len) == 0,
+              "fallback output matches one-shot");
+  ASSERT_EQ((int)ks.valid, 1, "mismatched keystream is not consumed");
+
+  /* Keystream shorter than the payload also falls back */
+  uint8_t big[80];
+  memset(big, 0x11, sizeof(big));
+  expected_len = tagotips_seal(
+    big, sizeof(big), TAGOTIPS_METHOD_PUSH, 5,
+    auth_hash, device_hash, key, expected, sizeof(expected));
+  sealed = tagotips_seal_precomputed(
+    &session, &ks, big, sizeof(big),
+    TAGOTIPS_METHOD_PUSH, 5, auth_hash, device_hash,
+    envelope, sizeof(envelope));
+  ASSERT_EQ(sealed, expected_len, "short keystream falls back");
+  ASSERT_TRUE(memcmp(envelope, expected, (size_t)expected_len) == 0,
+              "short-keystream fallback matches one-shot");
+
+  tagotips_keystream_destroy(&ks);
+  ASSERT_EQ((int)ks.valid, 0, "destroy invalidates keystream");
+
+  int zeroed = 1;
+  for (size_t i = 0; i < sizeof(ks_buf); i++) {
+    if (ks_buf[i] != 0) zeroed = 0;
+  }
+  ASSERT_TRUE(zeroed, "destroy wipes keystream bytes");
+
+  tagotips_session_destroy(&session);
+}
+
+/* =========================================================================
+ * Key-schedule cache
+ * ========================================================================= */
+
+void test_keycache_init_validates_capacity(void) {
+  tagotips_keycache_t cache;
+  tagotips_keycache_entry_t entries[8];
+
+  ASSERT_EQ(tagotips_keycache_init(&cache, entries, 8), TAGOTIPS_OK,
+            "keycache init with power-of-two capacity");
+  ASSERT_EQ(tagotips_keycache_init(&cache, entries, 0), TAGOTIPS_ERR_INVALID_ARG,
+            "keycache init rejects zero capacity");
+  ASSERT_EQ(tagotips_keycache_init(&cache, entries, 6), TAGOTIPS_ERR_INVALID_ARG,
+            "keycache init rejects non-power-of-two capacity");
+  ASSERT_EQ(tagotips_keycache_init(NULL, entries, 8), TAGOTIPS_ERR_NULL_PTR,
+            "keycache init rejects NULL cache");
+  ASSERT_EQ(tagotips_keycache_init(&cache, NULL, 8), TAGOTIPS_ERR_NULL_PTR,
+            "keycache init rejects NULL entries");
+}
+
+void test_keycache_open_cached_spec_envelope(void) {
+  tagotips_keycache_t cache;
+  tagotips_keycache_entry_t entries[8];
+  tagotips_keycache_init(&cache, entries, 8);
+
+  ASSERT_EQ(tagotips_keycache_put(&cache, SPEC_DEVICE_HASH, SPEC_KEY), TAGOTIPS_OK,
+            "keycache put spec device");
+  ASSERT_TRUE(tagotips_keycache_get(&cache, SPEC_DEVICE_HASH) != NULL,
+              "keycache get finds spec device");
+
+  TagotipsHeader hdr;
+  uint8_t method;
+  uint8_t inner[64];
+  int32_t rc = tagotips_open_cached(
+    &cache, SPEC_ENVELOPE, sizeof(SPEC_ENVELOPE),
+    &hdr, &method, inner, sizeof(inner));
+
+  ASSERT_EQ(rc, 20, "open_cached returns 20 bytes plaintext");
+  ASSERT_EQ(method, TAGOTIPS_METHOD_PUSH, "open_cached method is PUSH");
+  ASSERT_MEM_EQ(hdr.device_hash, SPEC_DEVICE_HASH, 8, "open_cached header device_hash");
+  ASSERT_MEM_EQ(inner, SPEC_INNER_FRAME, 20, "open_cached plaintext matches spec");
+
+  tagotips_keycache_destroy(&cache);
+}
+
+void test_keycache_unknown_device(void) {
+  tagotips_keycache_t cache;
+  tagotips_keycache_entry_t entries[4];
+  tagotips_keycache_init(&cache, entries, 4);
+
+  TagotipsHeader hdr;
+  uint8_t method;
+  uint8_t inner[64];
+  int32_t rc = tagotips_open_cached(
+    &cache, SPEC_ENVELOPE, sizeof(SPEC_ENVELOPE),
+    &hdr, &method, inner, sizeof(inner));
+
+  ASSERT_EQ(rc, TAGOTIPS_ERR_UNKNOWN_DEVICE, "open_cached rejects unknown device");
+  /* Header is still parsed so the gateway can log the offending device */
+  ASSERT_MEM_EQ(hdr.device_hash, SPEC_DEVICE_HASH, 8,
+                "open_cached fills header before key lookup");
+}
+
+void test_keycache_rekey_and_remove(void) {
+  tagotips_keycache_t cache;
+  tagotips_keycache_entry_t entries[4];
+  tagotips_keycache_init(&cache, entries, 4);
+
+  uint8_t wrong_key[16] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                             0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+
+  /* Stale key fails authentication; re-put with the right key recovers */
+  tagotips_keycache_put(&cache, SPEC_DEVICE_HASH, wrong_key);
+
+  TagotipsHeader hdr;
+  uint8_t method;
+  uint8_t inner[64];
+  int32_t rc = tagotips_open_cached(
+    &cache, SPEC_ENVELOPE, sizeof(SPEC_ENVELOPE),
+    &hdr, &method, inner, sizeof(inner));
+  ASSERT_EQ(rc, TAGOTIPS_ERR_DECRYPTION_FAILED, "open_cached fails with stale key");
+
+  ASSERT_EQ(tagotips_keycache_put(&cache, SPEC_DEVICE_HASH, SPEC_KEY), TAGOTIPS_OK,
+            "keycache rekey in place");
+  rc = tagotips_open_cached(
+    &cache, SPEC_ENVELOPE, sizeof(SPEC_ENVELOPE),
+    &hdr, &method, inner, sizeof(inner));
+  ASSERT_EQ(rc, 20, "open_cached succeeds after rekey");
+
+  ASSERT_EQ(tagotips_keycache_remove(&cache, SPEC_DEVICE_HASH), TAGOTIPS_OK,
+            "keycache remove known device");
+  ASSERT_TRUE(tagotips_keycache_get(&cache, SPEC_DEVICE_HASH) == NULL,
+              "keycache get misses after remove");
+  ASSERT_EQ(tagotips_keycache_remove(&cache, SPEC_DEVICE_HASH),
+            TAGOTIPS_ERR_UNKNOWN_DEVICE, "keycache remove unknown device");
+}
+
+void test_keycache_full_and_probing(void) {
+  tagotips_keycache_t cache;
+  tagotips_keycache_entry_t entries[4];
+  tagotips_keycache_init(&cache, entries, 4);
+
+  uint8_t key[16] = { 0 };
+  uint8_t hashes[5][8];
+  for (int i = 0; i < 5; i++) {
+    char serial[16];
+    snprintf(serial, sizeof(serial), "gw-dev-%d", i);
+    tagotips_derive_device_hash(serial, hashes[i]);
+  }
+
+  for (int i = 0; i < 4; i++) {
+    key[0] = (uint8_t)i;
+    ASSERT_EQ(tagotips_keycache_put(&cache, hashes[i], key), TAGOTIPS_OK,
+              "keycache put into free slot");
+  }
+  key[0] = 4;
+  ASSERT_EQ(tagotips_keycache_put(&cache, hashes[4], key),
+            TAGOTIPS_ERR_BUFFER_TOO_SMALL, "keycache put rejects when full");
+
+  /* Every inserted device is still reachable despite probe collisions */
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(tagotips_keycache_get(&cache, hashes[i]) != NULL,
+                "keycache get after collisions");
+  }
+
+  /* Removing one frees a slot for the fifth device */
+  tagotips_keycache_remove(&cache, hashes[1]);
+  ASSERT_EQ(tagotips_keycache_put(&cache, hashes[4], key), TAGOTIPS_OK,
+            "keycache put reuses tombstoned slot");
+  ASSERT_TRUE(tagotips_keycache_get(&cache, hashes[4]) != NULL,
+              "keycache get device inserted over tombstone");
+  ASSERT_TRUE(tagotips_keycache_get(&cache, hashes[3]) != NULL,
+              "keycache probe walks past tombstone");
+
+  tagotips_keycache_destroy(&cache);
+}
+
+/* =========================================================================
+ * Batch open
+ * ========================================================================= */
+
+#define BATCH_COUNT 12
+
+void test_open_batch_round_trip(void) {
+  tagotips_keycache_t cache;
+  tagotips_keycache_entry_t entries[8];
+  tagotips_keycache_init(&cache, entries, 8);
+
+  /* Three devices, a few envelopes each, varying payload sizes */
+  uint8_t auth_hash[8], device_hashes[3][8], keys[3][16];
+  tagotips_derive_auth_hash("atdeadbeef1234567890abcdef1234567890", auth_hash);
+  for (int d = 0; d < 3; d++) {
+    char serial[16];
+    snprintf(serial, sizeof(serial), "batch-dev-%d", d);
+    tagotips_derive_device_hash(serial, device_hashes[d]);
+    memset(keys[d], (uint8_t)(d + 1), 16);
+    tagotips_keycache_put(&cache, device_hashes[d], keys[d]);
+  }
+
+  static uint8_t envelopes[BATCH_COUNT][256];
+  static uint8_t plaintexts[BATCH_COUNT][128];
+  static uint8_t inners[BATCH_COUNT][128];
+  tagotips_batch_item_t items[BATCH_COUNT];
+
+  for (int i = 0; i < BATCH_COUNT; i++) {
+    size_t pt_len = (size_t)(5 + i * 9);
+    for (size_t j = 0; j < pt_len; j++) {
+      plaintexts[i][j] = (uint8_t)(i * 31 + j);
+    }
+    int d = i % 3;
+    int32_t sealed = tagotips_seal(
+      plaintexts[i], pt_len,
+      TAGOTIPS_METHOD_PUSH, (uint32_t)(100 + i),
+      auth_hash, device_hashes[d], keys[d],
+      envelopes[i], sizeof(envelopes[i]));
+    ASSERT_TRUE(sealed > 0, "batch seal succeeds");
+
+    items[i].envelope = envelopes[i];
+    items[i].envelope_len = (size_t)sealed;
+    items[i].out_inner = inners[i];
+    items[i].out_inner_len = sizeof(inners[i]);
+  }
+
+  /* Sequential path and (in threaded builds) the worker-pool path must
+   * produce identical per-item results */
+  size_t thread_counts[] = { 1, 4 };
+  for (size_t t = 0; t < 2; t++) {
+    memset(inners, 0, sizeof(inners));
+    int32_t opened = tagotips_open_batch(&cache, items, BATCH_COUNT,
+                                         thread_counts[t]);
+    ASSERT_EQ(opened, BATCH_COUNT, "batch open opens every envelope");
+    for (int i = 0; i < BATCH_COUNT; i++) {
+      ASSERT_EQ(items[i].status, (int32_t)(5 + i * 9), "batch item status is length");
+      ASSERT_EQ((int)items[i].header.counter, 100 + i, "batch item counter");
+      ASSERT_EQ(items[i].method, TAGOTIPS_METHOD_PUSH, "batch item method");
+      ASSERT_TRUE(memcmp(inners[i], plaintexts[i], (size_t)items[i].status) == 0,
+                  "batch item plaintext");
+    }
+  }
+
+  tagotips_keycache_destroy(&cache);
+}
+
+void test_open_batch_mixed_failures(void) {
+  tagotips_keycache_t cache;
+  tagotips_keycache_entry_t entries[4];
+  tagotips_keycache_init(&cache, entries, 4);
+  tagotips_keycache_put(&cache, SPEC_DEVICE_HASH, SPEC_KEY);
+
+  uint8_t unknown_hash[8];
+  tagotips_derive_device_hash("not-in-cache", unknown_hash);
+
+  uint8_t good[64], tampered[64], foreign[64];
+  memcpy(good, SPEC_ENVELOPE, sizeof(SPEC_ENVELOPE));
+  memcpy(tampered, SPEC_ENVELOPE, sizeof(SPEC_ENVELOPE));
+  tampered[25] ^= 0x01;
+  int32_t foreign_len = tagotips_seal(
+    (const uint8_t *)"x", 1, TAGOTIPS_METHOD_PING, 7,
+    SPEC_AUTH_HASH, unknown_hash, SPEC_KEY, foreign, sizeof(foreign));
+  ASSERT_TRUE(foreign_len > 0, "foreign seal succeeds");
+
+  uint8_t inners[3][64];
+  tagotips_batch_item_t items[3];
+  items[0].envelope = good;
+  items[0].envelope_len = sizeof(SPEC_ENVELOPE);
+  items[1].envelope = tampered;
+  items[1].envelope_len = sizeof(SPEC_ENVELOPE);
+  items[2].envelope = foreign;
+  items[2].envelope_len = (size_t)foreign_len;
+  for (int i = 0; i < 3; i++) {
+    items[i].out_inner = inners[i];
+    items[i].out_inner_len = sizeof(inners[i]);
+  }
+
+  int32_t opened = tagotips_open_batch(&cache, items, 3, 2);
+  ASSERT_EQ(opened, 1, "batch open counts only successes");
+  ASSERT_EQ(items[0].status, 20, "batch good envelope opens");
+  ASSERT_EQ(items[1].status, TAGOTIPS_ERR_DECRYPTION_FAILED,
+            "batch tampered envelope fails");
+  ASSERT_EQ(items[2].status, TAGOTIPS_ERR_UNKNOWN_DEVICE,
+            "batch unknown device fails");
+
+  ASSERT_EQ(tagotips_open_batch(NULL, items, 3, 1), TAGOTIPS_ERR_NULL_PTR,
+            "batch open rejects NULL cache");
+  ASSERT_EQ(tagotips_open_batch(&cache, NULL, 3, 1), TAGOTIPS_ERR_NULL_PTR,
+            "batch open rejects NULL items");
+  ASSERT_EQ(tagotips_open_batch(&cache, NULL, 0, 0), 0,
+            "batch open of zero items is a no-op");
+
+  tagotips_keycache_destroy(&cache);
+}
+
+/* =========================================================================
+ * Statistics counters (only in -DTAGOTIPS_STATS builds)
+ * ========================================================================= */
+
+#ifdef TAGOTIPS_STATS
+
+void test_stats_counters(void) {
+  tagotips_reset_stats();
+
+  uint8_t envelope[64], inner[64], tiny[4];
+  TagotipsHeader hdr;
+  uint8_t method;
+
+  /* Two seals, one open, one tag failure, one short buffer each way */
+  tagotips_seal(SPEC_INNER_FRAME, sizeof(SPEC_INNER_FRAME),
+                TAGOTIPS_METHOD_PUSH, SPEC_COUNTER,
+                SPEC_AUTH_HASH, SPEC_DEVICE_HASH, SPEC_KEY,
+                envelope, sizeof(envelope));
+  tagotips_seal(SPEC_INNER_FRAME, sizeof(SPEC_INNER_FRAME),
+                TAGOTIPS_METHOD_PUSH, SPEC_COUNTER,
+                SPEC_AUTH_HASH, SPEC_DEVICE_HASH, SPEC_KEY,
+                envelope, sizeof(envelope));
+  tagotips_seal(SPEC_INNER_FRAME, sizeof(SPEC_INNER_FRAME),
+                TAGOTIPS_METHOD_PUSH, SPEC_COUNTER,
+                SPEC_AUTH_HASH, SPEC_DEVICE_HASH, SPEC_KEY,
+                tiny, sizeof(tiny));
+
+  tagotips_open(envelope, 49, SPEC_KEY, &hdr, &method, inner, sizeof(inner));
+  tagotips_open(envelope, 49, SPEC_KEY, &hdr, &method, tiny, sizeof(tiny));
+  envelope[25] ^= 0x01;
+  tagotips_open(envelope, 49, SPEC_KEY, &hdr, &method, inner, sizeof(inner));
+
+  tagotips_stats_t stats;
+  tagotips_get_stats(&stats);
+  ASSERT_EQ((int)stats.frames_sealed, 2, "stats frames_sealed");
+  ASSERT_EQ((int)stats.bytes_sealed, 40, "stats bytes_sealed");
+  ASSERT_EQ((int)stats.frames_opened, 1, "stats frames_opened");
+  ASSERT_EQ((int)stats.bytes_opened, 20, "stats bytes_opened");
+  ASSERT_EQ((int)stats.auth_failures, 1, "stats auth_failures");
+  ASSERT_EQ((int)stats.buffer_too_small, 2, "stats buffer_too_small");
+
+  tagotips_reset_stats();
+  tagotips_get_stats(&stats);
+  ASSERT_EQ((int)stats.frames_sealed, 0, "stats reset clears counters");
+}
+
+#endif /* TAGOTIPS_STATS */
+
 /* =========================================================================
  * Main
  * ========================================================================= */
@@ -720,6 +2098,8 @@ int main(void) {
   /* SHA-256 */
   test_sha256_empty();
   test_sha256_abc();
+  test_sha256_streaming_chunked();
+  test_sha256_streaming_block_boundary();
 
   /* Hash derivation */
   test_auth_hash_derivation();
@@ -734,9 +2114,48 @@ int main(void) {
 
   /* Round-trip */
   test_round_trip();
+  test_round_trip_stride_boundaries();
+  test_round_trip_multi_block();
   test_round_trip_empty_plaintext();
   test_all_methods_round_trip();
 
+  /* In-place seal/open */
+  test_seal_inplace_spec_envelope();
+  test_open_inplace_spec_envelope();
+  test_inplace_round_trip_multi_block();
+  test_inplace_buffer_too_small();
+  test_session_inplace_round_trip();
+
+  /* Streaming seal */
+  test_stream_seal_spec_envelope();
+  test_stream_seal_single_shot_equivalence();
+  test_stream_seal_length_mismatch();
+
+  /* Session API */
+  test_session_seal_spec_envelope();
+  test_session_open_spec_envelope();
+  test_session_reuse_across_counters();
+  test_session_destroy_zeroes_schedule();
+  test_session_null_pointers();
+
+  /* Truncated tag cipher (CCM-4) */
+  test_ccm4_seal_spec_envelope();
+  test_ccm4_open_detects_cipher();
+  test_ccm4_session_seal_matches();
+  test_ccm4_tampered_envelope_fails();
+  test_seal_cipher_rejects_unsupported();
+
+  /* Workspace API */
+  test_workspace_seal_open_spec_envelope();
+  test_workspace_derive_key_matches();
+  test_workspace_null_pointers();
+
+  /* Counter manager */
+  test_counter_commit_interval();
+  test_counter_boot_resume();
+  test_counter_flush_and_store_failure();
+  test_counter_seal_round_trip();
+
   /* Parse header */
   test_parse_header();
 
@@ -762,6 +2181,39 @@ int main(void) {
   test_derive_key_16_bytes();
   test_derive_key_without_prefix();
   test_derive_key_seal_open_round_trip();
+  test_derive_key_cached_matches_uncached();
+  test_derive_key_cached_many_serials();
+  test_derive_key_cached_null_pointers();
+
+  test_identity_init_caches_hashes();
+  test_identity_seal_matches_oneshot();
+  test_identity_round_trip();
+  test_identity_destroy_zeroes_state();
+  test_identity_null_pointers();
+
+  /* Cooperative seal */
+  test_coop_seal_matches_oneshot();
+  test_coop_seal_argument_checks();
+
+  /* Keystream precomputation */
+  test_keystream_precomputed_matches_oneshot();
+  test_keystream_mismatch_falls_back();
+
+  /* Key-schedule cache */
+  test_keycache_init_validates_capacity();
+  test_keycache_open_cached_spec_envelope();
+  test_keycache_unknown_device();
+  test_keycache_rekey_and_remove();
+  test_keycache_full_and_probing();
+
+  /* Batch open */
+  test_open_batch_round_trip();
+  test_open_batch_mixed_failures();
+
+#ifdef TAGOTIPS_STATS
+  /* Statistics counters */
+  test_stats_counters();
+#endif
 
   /* Hex utilities */
   test_hex_to_bytes_valid();
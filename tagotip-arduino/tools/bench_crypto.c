@@ -0,0 +1,176 @@
+/**
+ * bench_crypto -- Throughput benchmarks for the TagoTiP/S crypto hot paths.
+ *
+ * Measures tagotips_seal, tagotips_open, the SHA-256 core, and
+ * tagotips_derive_key at representative payload sizes (64 B, 1 KB,
+ * 16 KB). Each case self-calibrates to a ~200 ms window and prints one
+ * machine-readable CSV line so results can be diffed release to release:
+ *
+ *   name,bytes,iters,ns_per_op,ops_per_s,mb_per_s,cycles_per_byte
+ *
+ * cycles_per_byte is filled in when the CPU clock is passed as the first
+ * argument in MHz (e.g. `bench_crypto 3000`), and left empty otherwise.
+ *
+ * bench_now_ns() is the only host dependency; on an MCU, point it at a
+ * cycle counter or micros() and the measurement loops run unchanged.
+ * The codec (parse/build) counterpart lives in the Rust workspace:
+ * `cargo bench -p tagotip-codec`.
+ *
+ * Build: cc -std=c99 -O2 -o bench_crypto tools/bench_crypto.c src/tagotips.c -I src
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tagotips.h"
+
+#define MIN_WINDOW_NS 200000000ULL
+
+static double g_cpu_mhz; /* 0 = unknown */
+
+static uint64_t bench_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void report(const char *name, size_t bytes, uint64_t iters, uint64_t total_ns) {
+  double ns_per_op = (double)total_ns / (double)iters;
+  double ops_per_s = 1e9 / ns_per_op;
+  double mb_per_s = bytes > 0 ? (double)bytes / ns_per_op * 1000.0 : 0.0;
+
+  printf("%s,%zu,%" PRIu64 ",%.1f,%.0f,%.1f,", name, bytes, iters, ns_per_op, ops_per_s, mb_per_s);
+  if (g_cpu_mhz > 0.0 && bytes > 0) {
+    printf("%.3f", ns_per_op * g_cpu_mhz / 1000.0 / (double)bytes);
+  }
+  printf("\n");
+}
+
+/* Self-calibrating measurement loop: op(iters) runs the workload and
+ * returns a value to sink so the compiler keeps it. */
+typedef size_t (*bench_op_t)(uint64_t iters);
+
+static volatile size_t g_sink;
+
+static void bench(const char *name, size_t bytes, bench_op_t op) {
+  uint64_t iters = 1;
+  for (;;) {
+    uint64_t start = bench_now_ns();
+    g_sink = op(iters);
+    uint64_t elapsed = bench_now_ns() - start;
+    if (elapsed >= MIN_WINDOW_NS || iters >= (1ULL << 30)) {
+      report(name, bytes, iters, elapsed);
+      return;
+    }
+    iters *= 2;
+  }
+}
+
+/* ---- Workloads -------------------------------------------------------- */
+
+static const char *BENCH_TOKEN = "atdeadbeef1234567890abcdef1234567890";
+static const char *BENCH_SERIAL = "bench-device-001";
+
+static size_t g_pt_len;
+static uint8_t g_plaintext[16384];
+static uint8_t g_envelope[TAGOTIPS_MAX_ENVELOPE];
+static size_t g_envelope_len;
+static uint8_t g_recovered[16384];
+static uint8_t g_auth_hash[8], g_device_hash[8], g_key[16];
+
+static size_t op_seal(uint64_t iters) {
+  size_t sink = 0;
+  for (uint64_t i = 0; i < iters; i++) {
+    int32_t rc = tagotips_seal(g_plaintext, g_pt_len, TAGOTIPS_METHOD_PUSH,
+                               (uint32_t)i, g_auth_hash, g_device_hash, g_key,
+                               g_envelope, sizeof(g_envelope));
+    sink += (size_t)rc;
+  }
+  return sink;
+}
+
+static size_t op_open(uint64_t iters) {
+  size_t sink = 0;
+  for (uint64_t i = 0; i < iters; i++) {
+    TagotipsHeader header;
+    uint8_t method;
+    int32_t rc = tagotips_open(g_envelope, g_envelope_len, g_key,
+                               &header, &method, g_recovered, sizeof(g_recovered));
+    sink += (size_t)rc;
+  }
+  return sink;
+}
+
+static size_t op_sha256(uint64_t iters) {
+  size_t sink = 0;
+  for (uint64_t i = 0; i < iters; i++) {
+    tagotips_sha256_ctx ctx;
+    uint8_t digest[32];
+    tagotips_sha256_init(&ctx);
+    tagotips_sha256_update(&ctx, g_plaintext, g_pt_len);
+    tagotips_sha256_final(&ctx, digest);
+    sink += digest[0];
+  }
+  return sink;
+}
+
+static size_t op_derive_key(uint64_t iters) {
+  size_t sink = 0;
+  for (uint64_t i = 0; i < iters; i++) {
+    uint8_t key[16];
+    tagotips_derive_key(BENCH_TOKEN, BENCH_SERIAL, key, sizeof(key));
+    sink += key[0];
+  }
+  return sink;
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    g_cpu_mhz = atof(argv[1]);
+  }
+
+  for (size_t i = 0; i < sizeof(g_plaintext); i++) {
+    g_plaintext[i] = (uint8_t)(i * 7 + 1);
+  }
+  tagotips_derive_auth_hash(BENCH_TOKEN, g_auth_hash);
+  tagotips_derive_device_hash(BENCH_SERIAL, g_device_hash);
+  tagotips_derive_key(BENCH_TOKEN, BENCH_SERIAL, g_key, sizeof(g_key));
+
+  printf("name,bytes,iters,ns_per_op,ops_per_s,mb_per_s,cycles_per_byte\n");
+
+  static const size_t SIZES[] = { 64, 1024, 16384 };
+  char name[48];
+
+  for (size_t s = 0; s < sizeof(SIZES) / sizeof(SIZES[0]); s++) {
+    g_pt_len = SIZES[s];
+
+    snprintf(name, sizeof(name), "seal_%zu", g_pt_len);
+    bench(name, g_pt_len, op_seal);
+
+    int32_t sealed = tagotips_seal(g_plaintext, g_pt_len, TAGOTIPS_METHOD_PUSH,
+                                   1, g_auth_hash, g_device_hash, g_key,
+                                   g_envelope, sizeof(g_envelope));
+    if (sealed <= 0) {
+      fprintf(stderr, "error: seal failed (%" PRId32 ")\n", sealed);
+      return 1;
+    }
+    g_envelope_len = (size_t)sealed;
+
+    snprintf(name, sizeof(name), "open_%zu", g_pt_len);
+    bench(name, g_pt_len, op_open);
+
+    snprintf(name, sizeof(name), "sha256_%zu", g_pt_len);
+    bench(name, g_pt_len, op_sha256);
+  }
+
+  bench("derive_key", 0, op_derive_key);
+
+  return 0;
+}
@@ -0,0 +1,88 @@
+/**
+ * gen_ttables -- Generate src/tagotips_ttables.h for the T-table strategy.
+ *
+ * Emits AES_TE0, the single 1 KB lookup table used by the
+ * TAGOTIPS_TABLE_STRATEGY=2 cipher in tagotips.c:
+ *
+ *   AES_TE0[x] = {02, 01, 01, 03} * S(x), packed big-endian
+ *
+ * The tables for the other three state rows are byte rotations of
+ * AES_TE0, so this is the only table that ships. The S-box itself is
+ * derived here from scratch (GF(2^8) inversion plus the affine map)
+ * rather than copied from tagotips.c, so a mismatch between the two
+ * would show up as a test failure instead of propagating silently.
+ *
+ * Build and regenerate: just gen-ttables
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define ROTL8(x, n) ((uint8_t)(((x) << (n)) | ((x) >> (8 - (n)))))
+
+static uint8_t gf_xtime(uint8_t x) {
+  return (uint8_t)((x << 1) ^ (((x >> 7) & 1) * 0x1b));
+}
+
+/*
+ * Classic S-box construction: walk the multiplicative group with
+ * generator 3 (p) while tracking its inverse (q), then apply the affine
+ * transform to each inverse pair.
+ */
+static void build_sbox(uint8_t sbox[256]) {
+  uint8_t p = 1;
+  uint8_t q = 1;
+
+  do {
+    /* p *= 3 */
+    p = (uint8_t)(p ^ (uint8_t)(p << 1) ^ (((p >> 7) & 1) * 0x1b));
+    /* q /= 3 */
+    q = (uint8_t)(q ^ (q << 1));
+    q = (uint8_t)(q ^ (q << 2));
+    q = (uint8_t)(q ^ (q << 4));
+    if (q & 0x80) {
+      q = (uint8_t)(q ^ 0x09);
+    }
+    sbox[p] = (uint8_t)(q ^ ROTL8(q, 1) ^ ROTL8(q, 2) ^ ROTL8(q, 3) ^ ROTL8(q, 4) ^ 0x63);
+  } while (p != 1);
+
+  sbox[0] = 0x63;
+}
+
+int main(void) {
+  uint8_t sbox[256];
+  build_sbox(sbox);
+
+  printf("/*\n");
+  printf(" * Generated by tools/gen_ttables.c -- do not edit by hand.\n");
+  printf(" *\n");
+  printf(" * AES_TE0[x] = {02, 01, 01, 03} * S(x), packed big-endian. Used by\n");
+  printf(" * the TAGOTIPS_TABLE_STRATEGY=2 cipher in tagotips.c; the other\n");
+  printf(" * three round tables are byte rotations of this one.\n");
+  printf(" */\n");
+  printf("\n");
+  printf("#ifndef TAGOTIPS_TTABLES_H\n");
+  printf("#define TAGOTIPS_TTABLES_H\n");
+  printf("\n");
+  printf("static const uint32_t AES_TE0[256] = {\n");
+
+  for (int i = 0; i < 256; i++) {
+    uint8_t s = sbox[i];
+    uint8_t s2 = gf_xtime(s);
+    uint8_t s3 = (uint8_t)(s2 ^ s);
+    uint32_t te0 = ((uint32_t)s2 << 24) | ((uint32_t)s << 16) | ((uint32_t)s << 8) | (uint32_t)s3;
+
+    if (i % 8 == 0) {
+      printf("  ");
+    }
+    printf("0x%08x%s", te0, i == 255 ? "" : ",");
+    printf(i % 8 == 7 ? "\n" : " ");
+  }
+
+  printf("};\n");
+  printf("\n");
+  printf("#endif /* TAGOTIPS_TTABLES_H */\n");
+  return 0;
+}
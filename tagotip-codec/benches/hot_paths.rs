@@ -0,0 +1,100 @@
+//! Throughput benchmarks for the codec hot paths.
+//!
+//! Run with `cargo bench -p tagotip-codec`. No harness dependency: each
+//! case self-calibrates to a ~200 ms measurement window and prints one
+//! machine-readable CSV line, so results can be diffed release to
+//! release:
+//!
+//! ```text
+//! name,bytes,iters,ns_per_op,ops_per_s,mb_per_s,cycles_per_byte
+//! ```
+//!
+//! `cycles_per_byte` is filled in when `TAGOTIP_BENCH_CPU_MHZ` is set in
+//! the environment (e.g. `TAGOTIP_BENCH_CPU_MHZ=3000`), and left empty
+//! otherwise.
+
+#![allow(clippy::cast_precision_loss)]
+
+use std::hint::black_box;
+use std::time::Instant;
+
+use tagotip_codec::build::build_uplink;
+use tagotip_codec::parse::parse_uplink;
+
+/// Build a PUSH frame close to (but not exceeding) `target` bytes.
+///
+/// Variable values are padded so large frames stay under the
+/// `MAX_VARIABLES` parser limit.
+fn frame_text(target: usize) -> String {
+    let header = "PUSH|!42|0123456789abcdef|bench-device-001|";
+    let pad = "x".repeat(target / tagotip_codec::consts::MAX_VARIABLES);
+    let mut body = String::new();
+    let mut i = 0;
+    loop {
+        let var = format!("sensor_{i:04}={pad}@1700000000^bench;");
+        if header.len() + body.len() + var.len() + 2 > target {
+            break;
+        }
+        body.push_str(&var);
+        i += 1;
+    }
+    if body.is_empty() {
+        body.push_str("t:=1;");
+    }
+    body.pop(); // trailing ';'
+    format!("{header}[{body}]")
+}
+
+fn cpu_mhz() -> Option<f64> {
+    std::env::var("TAGOTIP_BENCH_CPU_MHZ")
+        .ok()
+        .and_then(|v| v.parse::<f64>().ok())
+}
+
+/// Run `op` in a self-calibrating loop and print one CSV line.
+fn bench(name: &str, bytes: usize, mut op: impl FnMut() -> usize) {
+    let mut iters: u64 = 1;
+    loop {
+        let start = Instant::now();
+        let mut sink = 0usize;
+        for _ in 0..iters {
+            sink = sink.wrapping_add(op());
+        }
+        black_box(sink);
+        let elapsed = start.elapsed();
+
+        if elapsed.as_millis() < 200 && iters < (1 << 30) {
+            iters *= 2;
+            continue;
+        }
+
+        let ns_per_op = elapsed.as_nanos() as f64 / iters as f64;
+        let ops_per_s = 1e9 / ns_per_op;
+        let mb_per_s = bytes as f64 / ns_per_op * 1000.0;
+        let cycles = cpu_mhz()
+            .map(|mhz| format!("{:.3}", ns_per_op * mhz / 1000.0 / bytes as f64))
+            .unwrap_or_default();
+        println!("{name},{bytes},{iters},{ns_per_op:.1},{ops_per_s:.0},{mb_per_s:.1},{cycles}");
+        break;
+    }
+}
+
+fn main() {
+    println!("name,bytes,iters,ns_per_op,ops_per_s,mb_per_s,cycles_per_byte");
+
+    for target in [64, 1024, 16_384] {
+        let text = frame_text(target);
+        let bytes = text.len();
+
+        bench(&format!("parse_uplink_{target}"), bytes, || {
+            let frame = parse_uplink(black_box(&text)).expect("bench frame parses");
+            black_box(&frame).serial.len()
+        });
+
+        let frame = parse_uplink(&text).expect("bench frame parses");
+        let mut buf = vec![0u8; bytes + 64];
+        bench(&format!("build_uplink_{target}"), bytes, || {
+            build_uplink(black_box(&frame), &mut buf).expect("bench frame builds")
+        });
+    }
+}
@@ -1,7 +1,7 @@
 /// Returns `true` if the string contains any backslash escape sequences.
 #[must_use]
 pub fn needs_unescape(s: &str) -> bool {
-    s.as_bytes().contains(&b'\\')
+    crate::scan::contains_byte(s.as_bytes(), b'\\')
 }
 
 /// Unescape a `TagoTiP` string into a caller-provided buffer.
@@ -9,6 +9,7 @@ pub mod error;
 pub mod escape;
 pub mod fmt;
 pub mod inline_vec;
+pub mod scan;
 pub mod types;
 pub mod validate;
 
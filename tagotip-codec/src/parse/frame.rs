@@ -1,11 +1,15 @@
 use crate::consts::{AUTH_HASH_LEN, MAX_UPLINK_FIELDS};
 use crate::error::{ParseError, ParseErrorKind};
 use crate::inline_vec::InlineVec;
+use crate::scan;
 use crate::types::Method;
 use crate::validate;
 
 /// Split a frame string by `|`, respecting `\|` escape sequences.
 /// Returns slices into the original string.
+///
+/// Uses the vectorized scan kernels to jump between delimiter/escape
+/// bytes instead of stepping byte-by-byte.
 #[must_use]
 pub fn split_fields(input: &str) -> InlineVec<&str, MAX_UPLINK_FIELDS> {
     let mut fields = InlineVec::new();
@@ -13,21 +17,19 @@ pub fn split_fields(input: &str) -> InlineVec<&str, MAX_UPLINK_FIELDS> {
     let mut start = 0;
     let mut i = 0;
 
-    while i < bytes.len() {
-        if bytes[i] == b'\\' && i + 1 < bytes.len() {
-            i += 2; // skip escape sequence
+    while let Some(hit) = scan::find_either(&bytes[i..], b'|', b'\\').map(|j| i + j) {
+        if bytes[hit] == b'\\' {
+            i = (hit + 2).min(bytes.len()); // skip escape sequence
             continue;
         }
-        if bytes[i] == b'|' {
-            let _ = fields.push(&input[start..i]);
-            start = i + 1;
-            // If we've filled the vec, put everything remaining in the last slot
-            if fields.len() == MAX_UPLINK_FIELDS - 1 {
-                let _ = fields.push(&input[start..]);
-                return fields;
-            }
+        let _ = fields.push(&input[start..hit]);
+        start = hit + 1;
+        i = start;
+        // If we've filled the vec, put everything remaining in the last slot
+        if fields.len() == MAX_UPLINK_FIELDS - 1 {
+            let _ = fields.push(&input[start..]);
+            return fields;
         }
-        i += 1;
     }
     let _ = fields.push(&input[start..]);
     fields
@@ -63,8 +63,8 @@ pub fn extract_serial(s: &str) -> Result<&str, ParseError> {
 ///
 /// The input should NOT include a trailing `\n`.
 pub fn parse_uplink(input: &str) -> Result<UplinkFrame<'_>, ParseError> {
-    // NUL byte check
-    if input.as_bytes().contains(&0) {
+    // NUL byte check (vectorized)
+    if crate::scan::contains_byte(input.as_bytes(), 0) {
         return Err(ParseError::new(ParseErrorKind::NulByte, 0));
     }
 
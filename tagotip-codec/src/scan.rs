@@ -0,0 +1,125 @@
+//! Vectorized byte-scan kernels for the parser hot paths.
+//!
+//! Frames are pipe/semicolon-delimited text, so parsing spends most of its
+//! time locating delimiter, escape, and forbidden bytes. These kernels scan
+//! 16 bytes per iteration using SSE2 on `x86_64` (baseline, no runtime
+//! dispatch needed) and NEON on `aarch64`, falling back to the scalar loop
+//! on other targets and for trailing partial chunks.
+
+mod scalar {
+    /// Return the index of the first byte equal to `a` or `b`.
+    #[must_use]
+    pub fn find_either(bytes: &[u8], a: u8, b: u8) -> Option<usize> {
+        bytes.iter().position(|&x| x == a || x == b)
+    }
+
+    /// Returns `true` if `bytes` contains `needle`.
+    #[must_use]
+    pub fn contains_byte(bytes: &[u8], needle: u8) -> bool {
+        bytes.contains(&needle)
+    }
+}
+
+#[cfg(target_arch = "x86_64")]
+mod simd {
+    use core::arch::x86_64::{
+        __m128i, _mm_cmpeq_epi8, _mm_loadu_si128, _mm_movemask_epi8, _mm_or_si128, _mm_set1_epi8,
+    };
+
+    const LANES: usize = 16;
+
+    /// Return the index of the first byte equal to `a` or `b`.
+    #[must_use]
+    #[allow(clippy::cast_ptr_alignment)] // _mm_loadu_si128 is an unaligned load
+    pub fn find_either(bytes: &[u8], a: u8, b: u8) -> Option<usize> {
+        let mut i = 0;
+        // SAFETY: SSE2 is baseline on x86_64; unaligned loads stay within
+        // `bytes` because the loop requires LANES bytes of headroom.
+        unsafe {
+            let va = _mm_set1_epi8(a as i8);
+            let vb = _mm_set1_epi8(b as i8);
+            while i + LANES <= bytes.len() {
+                let chunk = _mm_loadu_si128(bytes.as_ptr().add(i).cast::<__m128i>());
+                let eq = _mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb));
+                let mask = _mm_movemask_epi8(eq);
+                if mask != 0 {
+                    return Some(i + mask.trailing_zeros() as usize);
+                }
+                i += LANES;
+            }
+        }
+        super::scalar::find_either(&bytes[i..], a, b).map(|j| i + j)
+    }
+
+    /// Returns `true` if `bytes` contains `needle`.
+    #[must_use]
+    #[allow(clippy::cast_ptr_alignment)] // _mm_loadu_si128 is an unaligned load
+    pub fn contains_byte(bytes: &[u8], needle: u8) -> bool {
+        let mut i = 0;
+        // SAFETY: as above.
+        unsafe {
+            let vn = _mm_set1_epi8(needle as i8);
+            while i + LANES <= bytes.len() {
+                let chunk = _mm_loadu_si128(bytes.as_ptr().add(i).cast::<__m128i>());
+                if _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vn)) != 0 {
+                    return true;
+                }
+                i += LANES;
+            }
+        }
+        super::scalar::contains_byte(&bytes[i..], needle)
+    }
+}
+
+#[cfg(target_arch = "aarch64")]
+mod simd {
+    use core::arch::aarch64::{vceqq_u8, vdupq_n_u8, vld1q_u8, vmaxvq_u8, vorrq_u8};
+
+    const LANES: usize = 16;
+
+    /// Return the index of the first byte equal to `a` or `b`.
+    #[must_use]
+    pub fn find_either(bytes: &[u8], a: u8, b: u8) -> Option<usize> {
+        let mut i = 0;
+        // SAFETY: NEON is baseline on aarch64; loads stay within `bytes`
+        // because the loop requires LANES bytes of headroom.
+        unsafe {
+            let va = vdupq_n_u8(a);
+            let vb = vdupq_n_u8(b);
+            while i + LANES <= bytes.len() {
+                let chunk = vld1q_u8(bytes.as_ptr().add(i));
+                let eq = vorrq_u8(vceqq_u8(chunk, va), vceqq_u8(chunk, vb));
+                if vmaxvq_u8(eq) != 0 {
+                    // Hit somewhere in this chunk; pinpoint it scalar-wise.
+                    return super::scalar::find_either(&bytes[i..i + LANES], a, b).map(|j| i + j);
+                }
+                i += LANES;
+            }
+        }
+        super::scalar::find_either(&bytes[i..], a, b).map(|j| i + j)
+    }
+
+    /// Returns `true` if `bytes` contains `needle`.
+    #[must_use]
+    pub fn contains_byte(bytes: &[u8], needle: u8) -> bool {
+        let mut i = 0;
+        // SAFETY: as above.
+        unsafe {
+            let vn = vdupq_n_u8(needle);
+            while i + LANES <= bytes.len() {
+                let chunk = vld1q_u8(bytes.as_ptr().add(i));
+                if vmaxvq_u8(vceqq_u8(chunk, vn)) != 0 {
+                    return true;
+                }
+                i += LANES;
+            }
+        }
+        super::scalar::contains_byte(&bytes[i..], needle)
+    }
+}
+
+#[cfg(any(target_arch = "x86_64", target_arch = "aarch64"))]
+pub use simd::{contains_byte, find_either};
+
+#[cfg(not(any(target_arch = "x86_64", target_arch = "aarch64")))]
+pub use scalar::{contains_byte, find_either};
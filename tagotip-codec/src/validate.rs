@@ -1,5 +1,6 @@
 use crate::consts;
 use crate::error::{ParseError, ParseErrorKind};
+use crate::scan;
 
 /// Validate a variable name: lowercase a-z, digits, underscore. Max 100 bytes.
 pub fn validate_varname(name: &str, pos: usize) -> Result<(), ParseError> {
@@ -76,6 +77,91 @@ pub fn validate_unit(unit: &str, pos: usize) -> Result<(), ParseError> {
     Ok(())
 }
 
+/// Advance to the end of the current pipe-delimited field, skipping `\|`
+/// escape sequences. Returns the index of the terminating `|`, or the input
+/// length if this is the last field.
+fn field_end(bytes: &[u8], start: usize) -> usize {
+    let mut i = start;
+    while let Some(hit) = scan::find_either(&bytes[i..], b'|', b'\\').map(|j| i + j) {
+        if bytes[hit] == b'\\' {
+            i = (hit + 2).min(bytes.len());
+            continue;
+        }
+        return hit;
+    }
+    bytes.len()
+}
+
+/// Cheap structural pre-validation of an uplink frame.
+///
+/// Performs only the checks needed to reject obviously malformed input —
+/// the size cap, NUL bytes, the method field, and the pipe-delimited header
+/// structure through the serial — without materializing anything. Operates
+/// on raw bytes, so garbage input never pays for UTF-8 validation either.
+///
+/// A frame that fails here would also fail `parse_uplink`; a frame that
+/// passes may still be rejected by the full parse (body contents are not
+/// inspected).
+pub fn validate_uplink_structure(input: &[u8]) -> Result<(), ParseError> {
+    if input.is_empty() {
+        return Err(ParseError::new(ParseErrorKind::EmptyFrame, 0));
+    }
+    if scan::contains_byte(input, 0) {
+        return Err(ParseError::new(ParseErrorKind::NulByte, 0));
+    }
+    if input.len() > consts::MAX_FRAME_SIZE {
+        return Err(ParseError::new(ParseErrorKind::FrameTooLarge, 0));
+    }
+
+    // Strip trailing \n if present (TCP transport)
+    let input = match input.split_last() {
+        Some((b'\n', rest)) => rest,
+        _ => input,
+    };
+
+    // METHOD: exactly 4 bytes, pipe-terminated
+    if input.len() < 4 || !matches!(&input[..4], b"PUSH" | b"PULL" | b"PING") {
+        return Err(ParseError::new(ParseErrorKind::InvalidMethod, 0));
+    }
+    if input.len() == 4 {
+        return Err(ParseError::new(ParseErrorKind::InvalidAuth, 4));
+    }
+    if input[4] != b'|' {
+        return Err(ParseError::new(ParseErrorKind::InvalidMethod, 0));
+    }
+
+    // Optional |!SEQ field
+    let mut pos = 5;
+    let mut end = field_end(input, pos);
+    if input[pos..end].first() == Some(&b'!') {
+        if end - pos < 2 {
+            return Err(ParseError::new(ParseErrorKind::InvalidSeq, pos));
+        }
+        if end == input.len() {
+            return Err(ParseError::new(ParseErrorKind::InvalidAuth, end));
+        }
+        pos = end + 1;
+        end = field_end(input, pos);
+    }
+
+    // |AUTH: exactly 16 bytes
+    if end - pos != consts::AUTH_HASH_LEN {
+        return Err(ParseError::new(ParseErrorKind::InvalidAuth, pos));
+    }
+    if end == input.len() {
+        return Err(ParseError::new(ParseErrorKind::InvalidSerial, end));
+    }
+
+    // |SERIAL: non-empty
+    pos = end + 1;
+    end = field_end(input, pos);
+    if end == pos {
+        return Err(ParseError::new(ParseErrorKind::InvalidSerial, pos));
+    }
+
+    Ok(())
+}
+
 /// Validate number format per spec: `-?(0|[1-9][0-9]*)(\.[0-9]+)?`
 pub fn validate_number(s: &str, pos: usize) -> Result<(), ParseError> {
     let bytes = s.as_bytes();
@@ -0,0 +1,58 @@
+//! Tests for the vectorized scan kernels.
+//!
+//! Exercises lengths around the 16-byte SIMD chunk boundary so the
+//! vector loop, the tail fallback, and the scalar path all get hit.
+
+use tagotip_codec::scan::{contains_byte, find_either};
+
+#[test]
+fn find_either_hits_both_needles() {
+    assert_eq!(find_either(b"abc|def", b'|', b'\\'), Some(3));
+    assert_eq!(find_either(b"abc\\def", b'|', b'\\'), Some(3));
+    assert_eq!(find_either(b"abcdef", b'|', b'\\'), None);
+}
+
+#[test]
+fn find_either_returns_first_hit() {
+    assert_eq!(find_either(b"a\\b|c", b'|', b'\\'), Some(1));
+    assert_eq!(find_either(b"a|b\\c", b'|', b'\\'), Some(1));
+}
+
+#[test]
+fn find_either_chunk_boundaries() {
+    // Needle at every offset across several 16-byte chunks.
+    for pos in 0..64 {
+        let mut buf = [b'a'; 64];
+        buf[pos] = b'|';
+        assert_eq!(find_either(&buf, b'|', b'\\'), Some(pos), "pos {pos}");
+    }
+}
+
+#[test]
+fn find_either_short_and_empty_inputs() {
+    assert_eq!(find_either(b"", b'|', b'\\'), None);
+    assert_eq!(find_either(b"|", b'|', b'\\'), Some(0));
+    for len in 1..16 {
+        let buf = vec![b'a'; len];
+        assert_eq!(find_either(&buf, b'|', b'\\'), None, "len {len}");
+    }
+}
+
+#[test]
+fn contains_byte_chunk_boundaries() {
+    for pos in 0..64 {
+        let mut buf = [b'x'; 64];
+        buf[pos] = 0;
+        assert!(contains_byte(&buf, 0), "pos {pos}");
+    }
+    assert!(!contains_byte(&[b'x'; 64], 0));
+    assert!(!contains_byte(b"", 0));
+}
+
+#[test]
+fn contains_byte_only_in_tail() {
+    // Hit in the <16-byte remainder after the vector loop.
+    let mut buf = vec![b'x'; 37];
+    buf[36] = b'\\';
+    assert!(contains_byte(&buf, b'\\'));
+}
@@ -0,0 +1,85 @@
+//! Tests for the structural uplink pre-validator.
+//!
+//! The validator must never pass a frame the full parser rejects for
+//! structural reasons, and must pass everything the parser accepts.
+
+use tagotip_codec::ParseErrorKind;
+use tagotip_codec::parse::parse_uplink;
+use tagotip_codec::validate::validate_uplink_structure;
+
+const AUTH: &str = "4deedd7bab8817ec";
+
+fn kind(input: &[u8]) -> Option<ParseErrorKind> {
+    validate_uplink_structure(input).err().map(|e| e.kind)
+}
+
+#[test]
+fn accepts_valid_frames() {
+    let frames = [
+        format!("PUSH|{AUTH}|sensor_01|[temperature:=32;humidity:=65]"),
+        format!("PUSH|!42|{AUTH}|sensor_01|[temp:=32]"),
+        format!("PUSH|{AUTH}|sensor_01|>xDEADBEEF"),
+        format!("PULL|{AUTH}|sensor_01|[temperature;humidity]"),
+        format!("PING|{AUTH}|sensor_01"),
+        format!("PING|{AUTH}|sensor_01\n"),
+    ];
+    for frame in &frames {
+        assert_eq!(kind(frame.as_bytes()), None, "rejected {frame:?}");
+        // Validator acceptance must agree with the full parser.
+        assert!(parse_uplink(frame).is_ok(), "parser rejected {frame:?}");
+    }
+}
+
+#[test]
+fn rejects_empty_and_oversized() {
+    assert_eq!(kind(b""), Some(ParseErrorKind::EmptyFrame));
+    let big = vec![b'a'; tagotip_codec::consts::MAX_FRAME_SIZE + 1];
+    assert_eq!(kind(&big), Some(ParseErrorKind::FrameTooLarge));
+}
+
+#[test]
+fn rejects_nul_bytes() {
+    let frame = format!("PING|{AUTH}|sensor\0_01");
+    assert_eq!(kind(frame.as_bytes()), Some(ParseErrorKind::NulByte));
+}
+
+#[test]
+fn rejects_bad_method() {
+    assert_eq!(kind(b"GET / HTTP/1.1"), Some(ParseErrorKind::InvalidMethod));
+    assert_eq!(kind(b"PU"), Some(ParseErrorKind::InvalidMethod));
+    assert_eq!(kind(b"PUSHX|rest"), Some(ParseErrorKind::InvalidMethod));
+    assert_eq!(
+        kind(b"push|4deedd7bab8817ec|s"),
+        Some(ParseErrorKind::InvalidMethod)
+    );
+    // Non-UTF-8 garbage must be rejected, not crash.
+    assert_eq!(
+        kind(&[0xff, 0xfe, 0x80, 0x81]),
+        Some(ParseErrorKind::InvalidMethod)
+    );
+}
+
+#[test]
+fn rejects_truncated_headers() {
+    assert_eq!(kind(b"PING"), Some(ParseErrorKind::InvalidAuth));
+    assert_eq!(kind(b"PUSH|shortauth|s"), Some(ParseErrorKind::InvalidAuth));
+    assert_eq!(
+        kind(format!("PUSH|{AUTH}").as_bytes()),
+        Some(ParseErrorKind::InvalidSerial)
+    );
+    assert_eq!(
+        kind(format!("PUSH|{AUTH}|").as_bytes()),
+        Some(ParseErrorKind::InvalidSerial)
+    );
+    assert_eq!(kind(b"PUSH|!|rest"), Some(ParseErrorKind::InvalidSeq));
+    assert_eq!(kind(b"PUSH|!42"), Some(ParseErrorKind::InvalidAuth));
+}
+
+#[test]
+fn passing_junk_is_still_caught_by_full_parse() {
+    // Structurally plausible but semantically invalid: the pre-validator
+    // passes it through; the parser is the authority.
+    let frame = format!("PUSH|{AUTH}|sensor_01|[not a variable]");
+    assert_eq!(kind(frame.as_bytes()), None);
+    assert!(parse_uplink(&frame).is_err());
+}
@@ -3,16 +3,34 @@
 //! Exposes parse/build functions through `extern "C"` so that every language
 //! binding (Node, Go, Python, Arduino) can call a single shared implementation.
 
+use std::ffi::c_void;
 use std::slice;
 use std::str;
 
-use tagotip_codec::consts::MAX_VARIABLES;
 use tagotip_codec::types::{
-    AckDetail, AckFrame, AckStatus, ErrorCode, MAX_TOTAL_META, Method, Operator,
-    PassthroughEncoding, PushBody, UplinkFrame, Value,
+    AckDetail, AckFrame, AckStatus, ErrorCode, Method, Operator, PassthroughEncoding, PushBody,
+    UplinkFrame, Value,
 };
 use tagotip_codec::{ParseError, ParseErrorKind};
 
+// ---------------------------------------------------------------------------
+// Capacity tier
+// ---------------------------------------------------------------------------
+
+/// Array capacities for the flat C structs. The default tier matches the
+/// codec limits; the `small-frame` feature shrinks `TagotipUplinkFrame` to a
+/// few hundred bytes for small-RAM targets. C callers must compile against
+/// tagotip.h with `TAGOTIP_SMALL_FRAME` defined to match.
+#[cfg(not(feature = "small-frame"))]
+pub const MAX_VARIABLES: usize = tagotip_codec::consts::MAX_VARIABLES;
+#[cfg(not(feature = "small-frame"))]
+pub const MAX_TOTAL_META: usize = tagotip_codec::types::MAX_TOTAL_META;
+
+#[cfg(feature = "small-frame")]
+pub const MAX_VARIABLES: usize = 16;
+#[cfg(feature = "small-frame")]
+pub const MAX_TOTAL_META: usize = 32;
+
 // ---------------------------------------------------------------------------
 // Error codes (negative = error, 0 = success, positive = bytes written)
 // ---------------------------------------------------------------------------
@@ -116,10 +134,16 @@ pub enum TagotipPushBodyTag {
 // ---------------------------------------------------------------------------
 
 /// A borrowed string slice (pointer + length, NOT null-terminated).
+///
+/// Parse functions set `needs_unescape` when the slice contains protocol
+/// escape sequences; clean slices can be consumed as-is, dirty ones are
+/// materialized on demand with `tagotip_unescape_into`. Build functions
+/// ignore the field on input.
 #[repr(C)]
 pub struct TagotipStr {
     pub ptr: *const u8,
     pub len: usize,
+    pub needs_unescape: u8,
 }
 
 impl TagotipStr {
@@ -127,6 +151,7 @@ impl TagotipStr {
         Self {
             ptr: std::ptr::null(),
             len: 0,
+            needs_unescape: 0,
         }
     }
 
@@ -134,6 +159,7 @@ impl TagotipStr {
         Self {
             ptr: s.as_ptr(),
             len: s.len(),
+            needs_unescape: u8::from(tagotip_codec::escape::needs_unescape(s)),
         }
     }
 
@@ -327,6 +353,19 @@ fn convert_error_code(c: &ErrorCode) -> TagotipErrorCode {
     }
 }
 
+fn convert_variable(var: &tagotip_codec::types::Variable<'_>) -> TagotipVariable {
+    TagotipVariable {
+        name: TagotipStr::from_str(var.name),
+        operator: convert_operator(&var.operator),
+        value: convert_value(&var.value),
+        unit: TagotipStr::from_option(var.unit),
+        timestamp: TagotipStr::from_option(var.timestamp),
+        group: TagotipStr::from_option(var.group),
+        meta_start: var.meta.map_or(0, |r| r.start),
+        meta_len: var.meta.map_or(0, |r| r.len),
+    }
+}
+
 fn convert_ack_status(s: &AckStatus) -> TagotipAckStatus {
     match s {
         AckStatus::Ok => TagotipAckStatus::Ok,
@@ -391,16 +430,7 @@ pub unsafe extern "C" fn tagotip_parse_uplink(
             let var_count = sb.variables.len().min(MAX_VARIABLES);
             out.variables_len = var_count as u16;
             for (i, var) in sb.variables.iter().enumerate().take(var_count) {
-                out.variables[i] = TagotipVariable {
-                    name: TagotipStr::from_str(var.name),
-                    operator: convert_operator(&var.operator),
-                    value: convert_value(&var.value),
-                    unit: TagotipStr::from_option(var.unit),
-                    timestamp: TagotipStr::from_option(var.timestamp),
-                    group: TagotipStr::from_option(var.group),
-                    meta_start: var.meta.map_or(0, |r| r.start),
-                    meta_len: var.meta.map_or(0, |r| r.len),
-                };
+                out.variables[i] = convert_variable(var);
             }
 
             let meta_count = sb.meta_pool.len().min(MAX_TOTAL_META);
@@ -447,6 +477,302 @@ pub unsafe extern "C" fn tagotip_parse_uplink(
     TAGOTIP_OK
 }
 
+/// Structurally pre-validate an uplink frame without parsing it.
+///
+/// Performs only cheap structural checks — the `TAGOTIP_MAX_FRAME_SIZE`
+/// cap, NUL bytes, the method field, and the pipe-delimited header through
+/// the serial — and writes nothing, so a hot ingestion loop can drop junk
+/// input without zeroing and populating a `TagotipUplinkFrame`. A frame
+/// that fails here would also fail `tagotip_parse_uplink`; a frame that
+/// passes may still be rejected by the full parse.
+///
+/// # Safety
+/// - `input_ptr` must point to a readable byte array of `input_len` bytes
+///   (UTF-8 is not required).
+///
+/// Returns 0 if the frame is structurally plausible, negative error code
+/// otherwise.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn tagotip_validate_uplink(input_ptr: *const u8, input_len: usize) -> i32 {
+    let input = unsafe { slice::from_raw_parts(input_ptr, input_len) };
+    match tagotip_codec::validate::validate_uplink_structure(input) {
+        Ok(()) => TAGOTIP_OK,
+        Err(e) => parse_error_to_code(&e),
+    }
+}
+
+/// Parse a batch of uplink frames in a single FFI call.
+///
+/// Each input slice is parsed independently; `out_status[i]` receives the
+/// same code `tagotip_parse_uplink` would return for input `i`, and
+/// `out_frames[i]` is only valid where the status is 0. A failed frame does
+/// not stop the batch.
+///
+/// # Safety
+/// - `inputs` must point to `count` valid `TagotipStr` slices of UTF-8 data.
+/// - `out_frames` must point to `count` writeable `TagotipUplinkFrame`s.
+/// - `out_status` must point to `count` writeable `int32_t`s.
+///
+/// Returns the number of successfully parsed frames.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn tagotip_parse_uplink_batch(
+    inputs: *const TagotipStr,
+    count: usize,
+    out_frames: *mut TagotipUplinkFrame,
+    out_status: *mut i32,
+) -> i32 {
+    if count == 0 {
+        return 0;
+    }
+    let inputs = unsafe { slice::from_raw_parts(inputs, count) };
+    let status = unsafe { slice::from_raw_parts_mut(out_status, count) };
+
+    let mut ok_count: i32 = 0;
+    for (i, input) in inputs.iter().enumerate() {
+        let rc = unsafe { tagotip_parse_uplink(input.ptr, input.len, out_frames.add(i)) };
+        status[i] = rc;
+        if rc == TAGOTIP_OK {
+            ok_count += 1;
+        }
+    }
+    ok_count
+}
+
+/// Owner index passed to `on_meta_pair` for body-level metadata
+/// (metadata not attached to any variable).
+pub const TAGOTIP_META_OWNER_BODY: u16 = u16::MAX;
+
+/// Uplink frame header delivered to `on_header`.
+#[repr(C)]
+pub struct TagotipUplinkHeader {
+    pub method: TagotipMethod,
+    pub has_seq: u8,
+    pub seq: u32,
+    pub auth: TagotipStr,
+    pub serial: TagotipStr,
+}
+
+/// Callbacks for the streaming uplink parser. Any callback may be NULL to
+/// skip those events. Each callback returns 0 to continue; a non-zero
+/// return aborts the parse and is returned verbatim to the caller.
+///
+/// All `TagotipStr` slices borrow from the input buffer and are only valid
+/// for the duration of the callback invocation's enclosing parse call.
+#[repr(C)]
+pub struct TagotipUplinkVisitor {
+    /// Called once with method, seq, auth, and serial.
+    pub on_header: Option<unsafe extern "C" fn(*const TagotipUplinkHeader, *mut c_void) -> i32>,
+    /// Called per variable in a structured PUSH body, with its index.
+    pub on_variable: Option<unsafe extern "C" fn(u16, *const TagotipVariable, *mut c_void) -> i32>,
+    /// Called per metadata pair with the owning variable's index, or
+    /// `TAGOTIP_META_OWNER_BODY` for body-level metadata.
+    pub on_meta_pair: Option<unsafe extern "C" fn(u16, *const TagotipMetaPair, *mut c_void) -> i32>,
+    /// Called once for a passthrough PUSH body.
+    pub on_passthrough:
+        Option<unsafe extern "C" fn(*const TagotipPassthroughBody, *mut c_void) -> i32>,
+    /// Called per requested variable name in a PULL body, with its index.
+    pub on_pull_variable: Option<unsafe extern "C" fn(u16, *const TagotipStr, *mut c_void) -> i32>,
+}
+
+/// Parse an uplink frame, delivering events through callbacks instead of
+/// populating a `TagotipUplinkFrame`.
+///
+/// Metadata pairs are emitted through `on_meta_pair` (body-level pairs
+/// first, then each variable's pairs after that variable's `on_variable`
+/// event), so no meta pool is exposed; `meta_len` on the delivered
+/// variable still carries the pair count.
+///
+/// # Safety
+/// - `input_ptr` must point to a valid UTF-8 byte array of `input_len` bytes.
+/// - `visitor` must point to a valid `TagotipUplinkVisitor`; its non-NULL
+///   function pointers must be callable with the documented signatures.
+///
+/// Returns 0 on success, a negative error code on parse failure, or the
+/// first non-zero callback return value.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn tagotip_parse_uplink_stream(
+    input_ptr: *const u8,
+    input_len: usize,
+    visitor: *const TagotipUplinkVisitor,
+    user_data: *mut c_void,
+) -> i32 {
+    let input = unsafe {
+        let bytes = slice::from_raw_parts(input_ptr, input_len);
+        match str::from_utf8(bytes) {
+            Ok(s) => s,
+            Err(_) => return TAGOTIP_ERR_INVALID_INPUT,
+        }
+    };
+
+    let frame = match tagotip_codec::parse::parse_uplink(input) {
+        Ok(f) => f,
+        Err(e) => return parse_error_to_code(&e),
+    };
+
+    let visitor = unsafe { &*visitor };
+
+    if let Some(cb) = visitor.on_header {
+        let header = TagotipUplinkHeader {
+            method: convert_method(&frame.method),
+            has_seq: u8::from(frame.seq.is_some()),
+            seq: frame.seq.unwrap_or(0),
+            auth: TagotipStr::from_str(frame.auth),
+            serial: TagotipStr::from_str(frame.serial),
+        };
+        let rc = unsafe { cb(&raw const header, user_data) };
+        if rc != 0 {
+            return rc;
+        }
+    }
+
+    match &frame.push_body {
+        Some(PushBody::Structured(sb)) => {
+            let pool = sb.meta_pool.as_slice();
+
+            if let (Some(cb), Some(range)) = (visitor.on_meta_pair, sb.body_meta) {
+                let start = range.start as usize;
+                for mp in &pool[start..start + range.len as usize] {
+                    let pair = TagotipMetaPair {
+                        key: TagotipStr::from_str(mp.key),
+                        value: TagotipStr::from_str(mp.value),
+                    };
+                    let rc = unsafe { cb(TAGOTIP_META_OWNER_BODY, &raw const pair, user_data) };
+                    if rc != 0 {
+                        return rc;
+                    }
+                }
+            }
+
+            for (i, var) in sb.variables.iter().enumerate() {
+                let index = i as u16;
+                if let Some(cb) = visitor.on_variable {
+                    let c_var = convert_variable(var);
+                    let rc = unsafe { cb(index, &raw const c_var, user_data) };
+                    if rc != 0 {
+                        return rc;
+                    }
+                }
+                if let (Some(cb), Some(range)) = (visitor.on_meta_pair, var.meta) {
+                    let start = range.start as usize;
+                    for mp in &pool[start..start + range.len as usize] {
+                        let pair = TagotipMetaPair {
+                            key: TagotipStr::from_str(mp.key),
+                            value: TagotipStr::from_str(mp.value),
+                        };
+                        let rc = unsafe { cb(index, &raw const pair, user_data) };
+                        if rc != 0 {
+                            return rc;
+                        }
+                    }
+                }
+            }
+        }
+        Some(PushBody::Passthrough(pt)) => {
+            if let Some(cb) = visitor.on_passthrough {
+                let body = TagotipPassthroughBody {
+                    encoding: match pt.encoding {
+                        PassthroughEncoding::Hex => TagotipPassthroughEncoding::Hex,
+                        PassthroughEncoding::Base64 => TagotipPassthroughEncoding::Base64,
+                    },
+                    data: TagotipStr::from_str(pt.data),
+                };
+                let rc = unsafe { cb(&raw const body, user_data) };
+                if rc != 0 {
+                    return rc;
+                }
+            }
+        }
+        None => {}
+    }
+
+    if let (Some(cb), Some(pb)) = (visitor.on_pull_variable, &frame.pull_body) {
+        for (i, name) in pb.variables.iter().enumerate() {
+            let s = TagotipStr::from_str(name);
+            let rc = unsafe { cb(i as u16, &raw const s, user_data) };
+            if rc != 0 {
+                return rc;
+            }
+        }
+    }
+
+    TAGOTIP_OK
+}
+
+// ---------------------------------------------------------------------------
+// Lazy unescape (caller arena)
+// ---------------------------------------------------------------------------
+
+/// A caller-provided bump arena for materializing unescaped strings.
+///
+/// Parsed `TagotipStr` slices borrow from the input buffer with escape
+/// sequences still in place; most contain none and never need rewriting.
+/// An arena lets a binding's ingestion loop materialize only the dirty
+/// slices into one flat buffer instead of taking a heap allocation per
+/// string. Resetting `used` to 0 (or re-initializing) reclaims the whole
+/// arena at once — typically once per frame or per batch.
+#[repr(C)]
+pub struct TagotipArena {
+    pub buf: *mut u8,
+    pub cap: usize,
+    pub used: usize,
+}
+
+/// Initialize an arena over a caller-owned buffer.
+///
+/// # Safety
+/// - `arena` must point to a writeable `TagotipArena`.
+/// - `buf_ptr` must point to a writeable buffer of at least `buf_len` bytes
+///   that outlives every string materialized into the arena.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn tagotip_arena_init(
+    arena: *mut TagotipArena,
+    buf_ptr: *mut u8,
+    buf_len: usize,
+) {
+    let a = unsafe { &mut *arena };
+    a.buf = buf_ptr;
+    a.cap = buf_len;
+    a.used = 0;
+}
+
+/// Materialize a parsed `TagotipStr` in place, unescaping it if needed.
+///
+/// A clean slice (`needs_unescape` zero) is returned untouched — no copy,
+/// no arena space. A dirty slice is decoded into the arena and `s` is
+/// rewritten to point at the decoded bytes, which stay valid until the
+/// arena is reset or its buffer is freed. On arena exhaustion the slice
+/// and the arena are left unchanged.
+///
+/// # Safety
+/// - `arena` must have been initialized with `tagotip_arena_init`.
+/// - `s` must point to a writeable `TagotipStr` referencing valid UTF-8
+///   data, as produced by the parse functions.
+///
+/// Returns 0 on success, negative error code if the arena is full.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn tagotip_unescape_into(
+    arena: *mut TagotipArena,
+    s: *mut TagotipStr,
+) -> i32 {
+    let s = unsafe { &mut *s };
+    if s.needs_unescape == 0 {
+        return TAGOTIP_OK;
+    }
+
+    let a = unsafe { &mut *arena };
+    let input = unsafe { tagotip_str_to_str(s) };
+    let free = unsafe { slice::from_raw_parts_mut(a.buf.add(a.used), a.cap - a.used) };
+    let Some(n) = tagotip_codec::escape::unescape_into(input, free) else {
+        return TAGOTIP_ERR_BUFFER_TOO_SMALL;
+    };
+
+    s.ptr = free.as_ptr();
+    s.len = n;
+    s.needs_unescape = 0;
+    a.used += n;
+    TAGOTIP_OK
+}
+
 /// Build an uplink frame into a buffer.
 ///
 /// # Safety
@@ -623,6 +949,780 @@ pub unsafe extern "C" fn tagotip_build_ack(
     }
 }
 
+// ---------------------------------------------------------------------------
+// Scatter-gather (iovec) build
+// ---------------------------------------------------------------------------
+
+/// Collects output segments for the iovec build mode. Separator and keyword
+/// segments point at static library data; formatted integers are written to
+/// the caller's scratch buffer; everything else references the caller's own
+/// strings unchanged.
+struct SegmentEmitter<'a> {
+    segments: &'a mut [TagotipStr],
+    count: usize,
+    scratch: &'a mut [u8],
+    scratch_pos: usize,
+}
+
+impl SegmentEmitter<'_> {
+    fn push(&mut self, ptr: *const u8, len: usize) -> Result<(), i32> {
+        if len == 0 {
+            return Ok(());
+        }
+        if self.count >= self.segments.len() {
+            return Err(TAGOTIP_ERR_BUFFER_TOO_SMALL);
+        }
+        self.segments[self.count] = TagotipStr {
+            ptr,
+            len,
+            needs_unescape: 0,
+        };
+        self.count += 1;
+        Ok(())
+    }
+
+    fn push_static(&mut self, s: &'static str) -> Result<(), i32> {
+        self.push(s.as_ptr(), s.len())
+    }
+
+    fn push_ref(&mut self, s: &TagotipStr) -> Result<(), i32> {
+        if s.ptr.is_null() {
+            return Ok(());
+        }
+        self.push(s.ptr, s.len)
+    }
+
+    fn push_u32(&mut self, value: u32) -> Result<(), i32> {
+        let n = tagotip_codec::fmt::format_u32(value, &mut self.scratch[self.scratch_pos..])
+            .ok_or(TAGOTIP_ERR_BUFFER_TOO_SMALL)?;
+        let ptr = self.scratch[self.scratch_pos..].as_ptr();
+        self.scratch_pos += n;
+        self.push(ptr, n)
+    }
+
+    fn push_meta_block(&mut self, pool: &[TagotipMetaPair]) -> Result<(), i32> {
+        self.push_static("{")?;
+        for (i, pair) in pool.iter().enumerate() {
+            if i > 0 {
+                self.push_static(",")?;
+            }
+            self.push_ref(&pair.key)?;
+            self.push_static("=")?;
+            self.push_ref(&pair.value)?;
+        }
+        self.push_static("}")
+    }
+
+    fn push_variable(
+        &mut self,
+        var: &TagotipVariable,
+        pool: &[TagotipMetaPair],
+    ) -> Result<(), i32> {
+        self.push_ref(&var.name)?;
+        match var.operator {
+            TagotipOperator::Number => {
+                self.push_static(":=")?;
+                self.push_ref(&var.value.str_val)?;
+            }
+            TagotipOperator::String => {
+                self.push_static("=")?;
+                self.push_ref(&var.value.str_val)?;
+            }
+            TagotipOperator::Boolean => {
+                self.push_static("?=")?;
+                self.push_static(if var.value.bool_val != 0 {
+                    "true"
+                } else {
+                    "false"
+                })?;
+            }
+            TagotipOperator::Location => {
+                self.push_static("@=")?;
+                self.push_ref(&var.value.lat)?;
+                self.push_static(",")?;
+                self.push_ref(&var.value.lng)?;
+                if var.value.alt.len > 0 {
+                    self.push_static(",")?;
+                    self.push_ref(&var.value.alt)?;
+                }
+            }
+        }
+        if var.unit.len > 0 {
+            self.push_static("#")?;
+            self.push_ref(&var.unit)?;
+        }
+        if var.timestamp.len > 0 {
+            self.push_static("@")?;
+            self.push_ref(&var.timestamp)?;
+        }
+        if var.group.len > 0 {
+            self.push_static("^")?;
+            self.push_ref(&var.group)?;
+        }
+        if var.meta_len > 0 {
+            let start = var.meta_start as usize;
+            self.push_meta_block(&pool[start..start + var.meta_len as usize])?;
+        }
+        Ok(())
+    }
+}
+
+/// Build an uplink frame as an iovec-style segment list instead of a
+/// contiguous buffer.
+///
+/// Small generated separators are interleaved with zero-copy references into
+/// the frame's own strings, so the transmit path can hand the segments to
+/// `writev()` directly and skip one full copy of every outbound frame.
+/// Unlike `tagotip_build_uplink`, the push/pull body is fully serialized.
+///
+/// Segments reference three kinds of storage: the frame's strings, static
+/// library data, and `scratch` (formatted sequence digits; 10 bytes suffice).
+/// They stay valid until the frame's strings or `scratch` are modified.
+///
+/// # Safety
+/// - `frame` must point to a valid `TagotipUplinkFrame`.
+/// - `segments` must point to `max_segments` writeable `TagotipStr`s.
+/// - `scratch_ptr` must point to a writeable buffer of `scratch_len` bytes.
+///
+/// Returns the number of segments emitted on success, negative error code
+/// on failure.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn tagotip_build_uplink_iovec(
+    frame: *const TagotipUplinkFrame,
+    segments: *mut TagotipStr,
+    max_segments: usize,
+    scratch_ptr: *mut u8,
+    scratch_len: usize,
+) -> i32 {
+    let frame = unsafe { &*frame };
+    let mut e = SegmentEmitter {
+        segments: unsafe { slice::from_raw_parts_mut(segments, max_segments) },
+        count: 0,
+        scratch: unsafe { slice::from_raw_parts_mut(scratch_ptr, scratch_len) },
+        scratch_pos: 0,
+    };
+
+    match emit_uplink(frame, &mut e) {
+        Ok(()) => e.count as i32,
+        Err(rc) => rc,
+    }
+}
+
+fn emit_uplink(frame: &TagotipUplinkFrame, e: &mut SegmentEmitter<'_>) -> Result<(), i32> {
+    e.push_static(match frame.method {
+        TagotipMethod::Push => "PUSH",
+        TagotipMethod::Pull => "PULL",
+        TagotipMethod::Ping => "PING",
+    })?;
+
+    if frame.has_seq != 0 {
+        e.push_static("|!")?;
+        e.push_u32(frame.seq)?;
+    }
+
+    e.push_static("|")?;
+    e.push_ref(&frame.auth)?;
+    e.push_static("|")?;
+    e.push_ref(&frame.serial)?;
+
+    match frame.method {
+        TagotipMethod::Push => match frame.push_body_tag {
+            TagotipPushBodyTag::Structured => {
+                e.push_static("|")?;
+                if frame.body_timestamp.len > 0 {
+                    e.push_static("@")?;
+                    e.push_ref(&frame.body_timestamp)?;
+                }
+                if frame.body_group.len > 0 {
+                    e.push_static("^")?;
+                    e.push_ref(&frame.body_group)?;
+                }
+                let pool = &frame.meta_pool[..(frame.meta_pool_len as usize).min(MAX_TOTAL_META)];
+                if frame.body_meta_len > 0 {
+                    let start = frame.body_meta_start as usize;
+                    e.push_meta_block(&pool[start..start + frame.body_meta_len as usize])?;
+                }
+                e.push_static("[")?;
+                let count = (frame.variables_len as usize).min(MAX_VARIABLES);
+                for (i, var) in frame.variables[..count].iter().enumerate() {
+                    if i > 0 {
+                        e.push_static(";")?;
+                    }
+                    e.push_variable(var, pool)?;
+                }
+                e.push_static("]")?;
+            }
+            TagotipPushBodyTag::Passthrough => {
+                e.push_static("|")?;
+                e.push_static(match frame.passthrough.encoding {
+                    TagotipPassthroughEncoding::Hex => ">x",
+                    TagotipPassthroughEncoding::Base64 => ">b",
+                })?;
+                e.push_ref(&frame.passthrough.data)?;
+            }
+            TagotipPushBodyTag::None => {}
+        },
+        TagotipMethod::Pull => {
+            if frame.has_pull_body != 0 {
+                e.push_static("|")?;
+                e.push_static("[")?;
+                let count = (frame.pull_variables_len as usize).min(MAX_VARIABLES);
+                for (i, name) in frame.pull_variables[..count].iter().enumerate() {
+                    if i > 0 {
+                        e.push_static(";")?;
+                    }
+                    e.push_ref(name)?;
+                }
+                e.push_static("]")?;
+            }
+        }
+        TagotipMethod::Ping => {}
+    }
+
+    Ok(())
+}
+
+/// Build an ACK frame as an iovec-style segment list.
+///
+/// Same storage and validity rules as `tagotip_build_uplink_iovec`; scratch
+/// is used for the sequence number and a count detail (20 bytes suffice).
+///
+/// # Safety
+/// - `frame` must point to a valid `TagotipAckFrame`.
+/// - `segments` must point to `max_segments` writeable `TagotipStr`s.
+/// - `scratch_ptr` must point to a writeable buffer of `scratch_len` bytes.
+///
+/// Returns the number of segments emitted on success, negative error code
+/// on failure.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn tagotip_build_ack_iovec(
+    frame: *const TagotipAckFrame,
+    segments: *mut TagotipStr,
+    max_segments: usize,
+    scratch_ptr: *mut u8,
+    scratch_len: usize,
+) -> i32 {
+    let frame = unsafe { &*frame };
+    let mut e = SegmentEmitter {
+        segments: unsafe { slice::from_raw_parts_mut(segments, max_segments) },
+        count: 0,
+        scratch: unsafe { slice::from_raw_parts_mut(scratch_ptr, scratch_len) },
+        scratch_pos: 0,
+    };
+
+    match emit_ack(frame, &mut e) {
+        Ok(()) => e.count as i32,
+        Err(rc) => rc,
+    }
+}
+
+fn emit_ack(frame: &TagotipAckFrame, e: &mut SegmentEmitter<'_>) -> Result<(), i32> {
+    e.push_static("ACK")?;
+
+    if frame.has_seq != 0 {
+        e.push_static("|!")?;
+        e.push_u32(frame.seq)?;
+    }
+
+    e.push_static("|")?;
+    e.push_static(match frame.status {
+        TagotipAckStatus::Ok => "OK",
+        TagotipAckStatus::Pong => "PONG",
+        TagotipAckStatus::Cmd => "CMD",
+        TagotipAckStatus::Err => "ERR",
+    })?;
+
+    match frame.detail.tag {
+        TagotipAckDetailTag::None => {}
+        TagotipAckDetailTag::Count => {
+            e.push_static("|")?;
+            e.push_u32(frame.detail.count)?;
+        }
+        TagotipAckDetailTag::Variables
+        | TagotipAckDetailTag::Command
+        | TagotipAckDetailTag::Error
+        | TagotipAckDetailTag::Raw => {
+            e.push_static("|")?;
+            e.push_ref(&frame.detail.text)?;
+        }
+    }
+
+    Ok(())
+}
+
+// ---------------------------------------------------------------------------
+// ACK template cache
+// ---------------------------------------------------------------------------
+
+/// Capacity of a cached ACK byte pattern. ACK frames are small
+/// (`ACK|!SEQ|STATUS[|DETAIL]`); the cap leaves generous room for a detail.
+pub const ACK_TEMPLATE_CAP: usize = 256;
+
+/// A pre-built ACK byte pattern with a recorded seq-field position.
+///
+/// For bulk downlink generation where every reply is identical except for
+/// the sequence number: build the template once, then stamp out each reply
+/// with `tagotip_ack_patch_seq` — a memcpy plus a few digit writes instead
+/// of a full build. The template owns its bytes (detail text is copied in),
+/// so the source frame may be discarded after init.
+#[repr(C)]
+pub struct TagotipAckTemplate {
+    pub buf: [u8; ACK_TEMPLATE_CAP],
+    pub len: usize,
+    pub seq_pos: usize,
+    pub seq_len: usize,
+}
+
+impl TagotipAckTemplate {
+    fn put(&mut self, data: &[u8]) -> i32 {
+        if self.len + data.len() > ACK_TEMPLATE_CAP {
+            return TAGOTIP_ERR_BUFFER_TOO_SMALL;
+        }
+        self.buf[self.len..self.len + data.len()].copy_from_slice(data);
+        self.len += data.len();
+        TAGOTIP_OK
+    }
+}
+
+/// Pre-build an ACK frame into a cached byte pattern.
+///
+/// The frame must carry a sequence number (`has_seq` non-zero); that is the
+/// field later patched per reply. Unlike `tagotip_build_ack`, the detail is
+/// fully serialized.
+///
+/// # Safety
+/// - `template` must point to a writeable `TagotipAckTemplate`.
+/// - `frame` must point to a valid `TagotipAckFrame`; a non-empty detail
+///   text must reference valid UTF-8 data.
+///
+/// Returns 0 on success, negative error code on failure.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn tagotip_ack_template_init(
+    template: *mut TagotipAckTemplate,
+    frame: *const TagotipAckFrame,
+) -> i32 {
+    let t = unsafe { &mut *template };
+    let frame = unsafe { &*frame };
+    t.len = 0;
+    t.seq_pos = 0;
+    t.seq_len = 0;
+
+    if frame.has_seq == 0 {
+        return TAGOTIP_ERR_INVALID_INPUT;
+    }
+
+    let mut rc = t.put(b"ACK|!");
+    if rc != TAGOTIP_OK {
+        return rc;
+    }
+    t.seq_pos = t.len;
+    let n = match tagotip_codec::fmt::format_u32(frame.seq, &mut t.buf[t.len..]) {
+        Some(n) => n,
+        None => return TAGOTIP_ERR_BUFFER_TOO_SMALL,
+    };
+    t.len += n;
+    t.seq_len = n;
+
+    rc = t.put(b"|");
+    if rc == TAGOTIP_OK {
+        rc = t.put(match frame.status {
+            TagotipAckStatus::Ok => b"OK".as_slice(),
+            TagotipAckStatus::Pong => b"PONG".as_slice(),
+            TagotipAckStatus::Cmd => b"CMD".as_slice(),
+            TagotipAckStatus::Err => b"ERR".as_slice(),
+        });
+    }
+    if rc != TAGOTIP_OK {
+        return rc;
+    }
+
+    match frame.detail.tag {
+        TagotipAckDetailTag::None => {}
+        TagotipAckDetailTag::Count => {
+            rc = t.put(b"|");
+            if rc != TAGOTIP_OK {
+                return rc;
+            }
+            let n = match tagotip_codec::fmt::format_u32(frame.detail.count, &mut t.buf[t.len..]) {
+                Some(n) => n,
+                None => return TAGOTIP_ERR_BUFFER_TOO_SMALL,
+            };
+            t.len += n;
+        }
+        TagotipAckDetailTag::Variables
+        | TagotipAckDetailTag::Command
+        | TagotipAckDetailTag::Error
+        | TagotipAckDetailTag::Raw => {
+            rc = t.put(b"|");
+            if rc == TAGOTIP_OK {
+                rc = t.put(unsafe { tagotip_str_to_str(&frame.detail.text) }.as_bytes());
+            }
+            if rc != TAGOTIP_OK {
+                return rc;
+            }
+        }
+    }
+
+    TAGOTIP_OK
+}
+
+/// Emit one ACK from a template, patching in a new sequence number.
+///
+/// Copies the cached pattern around the recorded seq position and writes
+/// the new digits in between; the patched seq may have a different digit
+/// count than the template's.
+///
+/// # Safety
+/// - `template` must have been initialized with `tagotip_ack_template_init`.
+/// - `out_ptr` must point to a writeable buffer of at least `out_len` bytes.
+///
+/// Returns bytes written on success, negative error code on failure.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn tagotip_ack_patch_seq(
+    template: *const TagotipAckTemplate,
+    seq: u32,
+    out_ptr: *mut u8,
+    out_len: usize,
+) -> i32 {
+    let t = unsafe { &*template };
+    let out = unsafe { slice::from_raw_parts_mut(out_ptr, out_len) };
+
+    let head = &t.buf[..t.seq_pos];
+    let tail = &t.buf[t.seq_pos + t.seq_len..t.len];
+
+    if head.len() > out.len() {
+        return TAGOTIP_ERR_BUFFER_TOO_SMALL;
+    }
+    out[..head.len()].copy_from_slice(head);
+    let mut pos = head.len();
+
+    let n = match tagotip_codec::fmt::format_u32(seq, &mut out[pos..]) {
+        Some(n) => n,
+        None => return TAGOTIP_ERR_BUFFER_TOO_SMALL,
+    };
+    pos += n;
+
+    if pos + tail.len() > out.len() {
+        return TAGOTIP_ERR_BUFFER_TOO_SMALL;
+    }
+    out[pos..pos + tail.len()].copy_from_slice(tail);
+    pos += tail.len();
+
+    pos as i32
+}
+
+// ---------------------------------------------------------------------------
+// Incremental uplink builder
+// ---------------------------------------------------------------------------
+
+/// Incremental uplink frame builder.
+///
+/// Serializes directly into the caller's output buffer as fields are added,
+/// so building a frame never requires a `TagotipUplinkFrame`. Callers
+/// allocate the struct (stack is fine) but must treat its fields as opaque:
+/// only `tagotip_builder_*` functions may touch them.
+#[repr(C)]
+pub struct TagotipBuilder {
+    pub buf: *mut u8,
+    pub cap: usize,
+    pub pos: usize,
+    pub method: TagotipMethod,
+    pub body_started: u8,
+    pub bracket_open: u8,
+    pub meta_open: u8,
+    pub err: i32,
+}
+
+impl TagotipBuilder {
+    fn put_bytes(&mut self, data: &[u8]) -> i32 {
+        if self.pos + data.len() > self.cap {
+            self.err = TAGOTIP_ERR_BUFFER_TOO_SMALL;
+            return self.err;
+        }
+        unsafe {
+            std::ptr::copy_nonoverlapping(data.as_ptr(), self.buf.add(self.pos), data.len());
+        }
+        self.pos += data.len();
+        TAGOTIP_OK
+    }
+
+    fn put_byte(&mut self, b: u8) -> i32 {
+        self.put_bytes(&[b])
+    }
+
+    fn put_u32(&mut self, value: u32) -> i32 {
+        let remaining =
+            unsafe { slice::from_raw_parts_mut(self.buf.add(self.pos), self.cap - self.pos) };
+        match tagotip_codec::fmt::format_u32(value, remaining) {
+            Some(n) => {
+                self.pos += n;
+                TAGOTIP_OK
+            }
+            None => {
+                self.err = TAGOTIP_ERR_BUFFER_TOO_SMALL;
+                self.err
+            }
+        }
+    }
+
+    /// Open the body (`|`) if this is the first body element.
+    fn ensure_body(&mut self) -> i32 {
+        if self.body_started == 0 {
+            let rc = self.put_byte(b'|');
+            if rc != TAGOTIP_OK {
+                return rc;
+            }
+            self.body_started = 1;
+        }
+        TAGOTIP_OK
+    }
+
+    /// Close an open `{...}` metadata block.
+    fn close_meta(&mut self) -> i32 {
+        if self.meta_open != 0 {
+            let rc = self.put_byte(b'}');
+            if rc != TAGOTIP_OK {
+                return rc;
+            }
+            self.meta_open = 0;
+        }
+        TAGOTIP_OK
+    }
+}
+
+fn operator_from_c(o: &TagotipOperator) -> Operator {
+    match o {
+        TagotipOperator::Number => Operator::Number,
+        TagotipOperator::String => Operator::String,
+        TagotipOperator::Boolean => Operator::Boolean,
+        TagotipOperator::Location => Operator::Location,
+    }
+}
+
+/// # Safety
+/// All non-empty `TagotipStr` fields must point to valid UTF-8 data that
+/// outlives the returned value.
+unsafe fn value_from_c<'a>(v: &TagotipValue) -> Value<'a> {
+    match v.tag {
+        TagotipValueTag::Number => Value::Number(unsafe { tagotip_str_to_str(&v.str_val) }),
+        TagotipValueTag::String => Value::String(unsafe { tagotip_str_to_str(&v.str_val) }),
+        TagotipValueTag::Boolean => Value::Boolean(v.bool_val != 0),
+        TagotipValueTag::Location => Value::Location {
+            lat: unsafe { tagotip_str_to_str(&v.lat) },
+            lng: unsafe { tagotip_str_to_str(&v.lng) },
+            alt: if v.alt.ptr.is_null() || v.alt.len == 0 {
+                None
+            } else {
+                Some(unsafe { tagotip_str_to_str(&v.alt) })
+            },
+        },
+    }
+}
+
+/// Initialize a builder and write the frame header (`METHOD|[!SEQ|]AUTH|SERIAL`).
+///
+/// A PING frame is complete after this call; `tagotip_builder_finish` then
+/// returns its length. For PUSH/PULL, follow with `tagotip_builder_add_*`.
+///
+/// # Safety
+/// - `builder` must point to a writeable `TagotipBuilder`.
+/// - `buf_ptr` must point to a writeable buffer of at least `buf_len` bytes
+///   that outlives the builder.
+/// - `auth` and `serial` must point to valid `TagotipStr` slices of UTF-8 data.
+///
+/// Returns 0 on success, negative error code on failure.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn tagotip_builder_init(
+    builder: *mut TagotipBuilder,
+    buf_ptr: *mut u8,
+    buf_len: usize,
+    method: TagotipMethod,
+    has_seq: u8,
+    seq: u32,
+    auth: *const TagotipStr,
+    serial: *const TagotipStr,
+) -> i32 {
+    let b = unsafe { &mut *builder };
+    b.buf = buf_ptr;
+    b.cap = buf_len;
+    b.pos = 0;
+    b.body_started = 0;
+    b.bracket_open = 0;
+    b.meta_open = 0;
+    b.err = TAGOTIP_OK;
+
+    let method_str = match method {
+        TagotipMethod::Push => "PUSH",
+        TagotipMethod::Pull => "PULL",
+        TagotipMethod::Ping => "PING",
+    };
+    b.method = method;
+
+    let mut rc = b.put_bytes(method_str.as_bytes());
+    if rc == TAGOTIP_OK && has_seq != 0 {
+        rc = b.put_bytes(b"|!");
+        if rc == TAGOTIP_OK {
+            rc = b.put_u32(seq);
+        }
+    }
+    if rc == TAGOTIP_OK {
+        rc = b.put_byte(b'|');
+    }
+    if rc == TAGOTIP_OK {
+        rc = b.put_bytes(unsafe { tagotip_str_to_str(&*auth) }.as_bytes());
+    }
+    if rc == TAGOTIP_OK {
+        rc = b.put_byte(b'|');
+    }
+    if rc == TAGOTIP_OK {
+        rc = b.put_bytes(unsafe { tagotip_str_to_str(&*serial) }.as_bytes());
+    }
+    rc
+}
+
+/// Append a variable to the frame body.
+///
+/// For PUSH frames the full variable (name, operator, value, unit,
+/// timestamp, group) is serialized; `meta_start`/`meta_len` are ignored —
+/// attach metadata with `tagotip_builder_add_meta` instead. For PULL frames
+/// only `var->name` is serialized. Invalid on PING frames.
+///
+/// # Safety
+/// - `builder` must have been initialized with `tagotip_builder_init`.
+/// - `var` must point to a valid `TagotipVariable` whose string fields
+///   reference valid UTF-8 data.
+///
+/// Returns 0 on success, negative error code on failure.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn tagotip_builder_add_variable(
+    builder: *mut TagotipBuilder,
+    var: *const TagotipVariable,
+) -> i32 {
+    let b = unsafe { &mut *builder };
+    if b.err != TAGOTIP_OK {
+        return b.err;
+    }
+    if matches!(b.method, TagotipMethod::Ping) {
+        b.err = TAGOTIP_ERR_INVALID_INPUT;
+        return b.err;
+    }
+
+    let mut rc = b.close_meta();
+    if rc == TAGOTIP_OK {
+        rc = b.ensure_body();
+    }
+    if rc == TAGOTIP_OK {
+        rc = if b.bracket_open == 0 {
+            b.bracket_open = 1;
+            b.put_byte(b'[')
+        } else {
+            b.put_byte(b';')
+        };
+    }
+    if rc != TAGOTIP_OK {
+        return rc;
+    }
+
+    let var = unsafe { &*var };
+    if matches!(b.method, TagotipMethod::Pull) {
+        return b.put_bytes(unsafe { tagotip_str_to_str(&var.name) }.as_bytes());
+    }
+
+    let rust_var = tagotip_codec::types::Variable {
+        name: unsafe { tagotip_str_to_str(&var.name) },
+        operator: operator_from_c(&var.operator),
+        value: unsafe { value_from_c(&var.value) },
+        unit: unsafe { tagotip_opt_str(&var.unit) },
+        timestamp: unsafe { tagotip_opt_str(&var.timestamp) },
+        group: unsafe { tagotip_opt_str(&var.group) },
+        meta: None,
+    };
+    let remaining = unsafe { slice::from_raw_parts_mut(b.buf.add(b.pos), b.cap - b.pos) };
+    match tagotip_codec::build::build_variable(&rust_var, &[], remaining) {
+        Ok(n) => {
+            b.pos += n;
+            TAGOTIP_OK
+        }
+        Err(_) => {
+            b.err = TAGOTIP_ERR_BUFFER_TOO_SMALL;
+            b.err
+        }
+    }
+}
+
+/// Append a metadata pair.
+///
+/// Before the first `tagotip_builder_add_variable` call the pair becomes
+/// body-level metadata; afterwards it attaches to the most recently added
+/// variable. Consecutive pairs accumulate into one `{...}` block. Only
+/// valid on PUSH frames.
+///
+/// # Safety
+/// - `builder` must have been initialized with `tagotip_builder_init`.
+/// - `key` and `value` must point to valid `TagotipStr` slices of UTF-8 data.
+///
+/// Returns 0 on success, negative error code on failure.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn tagotip_builder_add_meta(
+    builder: *mut TagotipBuilder,
+    key: *const TagotipStr,
+    value: *const TagotipStr,
+) -> i32 {
+    let b = unsafe { &mut *builder };
+    if b.err != TAGOTIP_OK {
+        return b.err;
+    }
+    if !matches!(b.method, TagotipMethod::Push) {
+        b.err = TAGOTIP_ERR_INVALID_INPUT;
+        return b.err;
+    }
+
+    let mut rc = b.ensure_body();
+    if rc == TAGOTIP_OK {
+        rc = if b.meta_open == 0 {
+            b.meta_open = 1;
+            b.put_byte(b'{')
+        } else {
+            b.put_byte(b',')
+        };
+    }
+    if rc == TAGOTIP_OK {
+        rc = b.put_bytes(unsafe { tagotip_str_to_str(&*key) }.as_bytes());
+    }
+    if rc == TAGOTIP_OK {
+        rc = b.put_byte(b'=');
+    }
+    if rc == TAGOTIP_OK {
+        rc = b.put_bytes(unsafe { tagotip_str_to_str(&*value) }.as_bytes());
+    }
+    rc
+}
+
+/// Finish the frame, closing any open body delimiters.
+///
+/// # Safety
+/// - `builder` must have been initialized with `tagotip_builder_init`.
+///
+/// Returns total bytes written on success, negative error code on failure.
+/// The builder must be re-initialized before reuse.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn tagotip_builder_finish(builder: *mut TagotipBuilder) -> i32 {
+    let b = unsafe { &mut *builder };
+    if b.err != TAGOTIP_OK {
+        return b.err;
+    }
+
+    let mut rc = b.close_meta();
+    if rc == TAGOTIP_OK && b.bracket_open != 0 {
+        rc = b.put_byte(b']');
+        b.bracket_open = 0;
+    }
+    if rc != TAGOTIP_OK {
+        return rc;
+    }
+    b.pos as i32
+}
+
 /// Helper to convert `TagotipStr` back to &str.
 ///
 /// # Safety
@@ -637,3 +1737,15 @@ unsafe fn tagotip_str_to_str<'a>(s: &TagotipStr) -> &'a str {
         }
     }
 }
+
+/// Like `tagotip_str_to_str`, but maps an empty slice to `None`.
+///
+/// # Safety
+/// - A non-empty `TagotipStr` must point to valid UTF-8 data.
+unsafe fn tagotip_opt_str<'a>(s: &TagotipStr) -> Option<&'a str> {
+    if s.ptr.is_null() || s.len == 0 {
+        None
+    } else {
+        Some(unsafe { tagotip_str_to_str(s) })
+    }
+}
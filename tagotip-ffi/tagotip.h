@@ -22,9 +22,21 @@ extern "C" {
  * Constants
  * ----------------------------------------------------------------------- */
 
+/*
+ * Frame struct capacities. Define TAGOTIP_SMALL_FRAME to get a compact
+ * TagotipUplinkFrame for small-RAM targets; the library must be built
+ * with the matching `small-frame` cargo feature or the struct layouts
+ * will not line up.
+ */
+#ifdef TAGOTIP_SMALL_FRAME
+#define TAGOTIP_MAX_VARIABLES    16
+#define TAGOTIP_MAX_TOTAL_META   32
+#else
 #define TAGOTIP_MAX_VARIABLES    100
-#define TAGOTIP_MAX_META_PAIRS   32
 #define TAGOTIP_MAX_TOTAL_META   512
+#endif
+
+#define TAGOTIP_MAX_META_PAIRS   32
 #define TAGOTIP_MAX_FRAME_SIZE   16384
 #define TAGOTIP_AUTH_HASH_LEN    16
 
@@ -122,12 +134,32 @@ typedef enum {
  * Structs
  * ----------------------------------------------------------------------- */
 
-/** Borrowed string slice (pointer + length, NOT null-terminated). */
+/**
+ * Borrowed string slice (pointer + length, NOT null-terminated).
+ *
+ * Parse functions set needs_unescape when the slice contains protocol
+ * escape sequences; clean slices can be consumed as-is, dirty ones are
+ * materialized on demand with tagotip_unescape_into(). Build functions
+ * ignore the field on input.
+ */
 typedef struct {
     const uint8_t *ptr;
     size_t len;
+    uint8_t needs_unescape;
 } TagotipStr;
 
+/**
+ * Caller-provided bump arena for materializing unescaped strings.
+ *
+ * Resetting used to 0 (or re-initializing) reclaims the whole arena at
+ * once — typically once per frame or per batch.
+ */
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t used;
+} TagotipArena;
+
 typedef struct {
     TagotipStr key;
     TagotipStr value;
@@ -201,6 +233,90 @@ typedef struct {
     TagotipAckDetail detail;
 } TagotipAckFrame;
 
+/**
+ * Incremental uplink frame builder.
+ *
+ * Serializes directly into the caller's output buffer as fields are added,
+ * so building a frame never requires a TagotipUplinkFrame. Allocate the
+ * struct anywhere (stack is fine) but treat its fields as opaque: only
+ * tagotip_builder_* functions may touch them.
+ */
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t pos;
+    TagotipMethod method;
+    uint8_t body_started;
+    uint8_t bracket_open;
+    uint8_t meta_open;
+    int32_t err;
+} TagotipBuilder;
+
+/**
+ * Capacity of a cached ACK byte pattern. ACK frames are small
+ * (ACK|!SEQ|STATUS[|DETAIL]); the cap leaves generous room for a detail.
+ */
+#define TAGOTIP_ACK_TEMPLATE_CAP 256
+
+/**
+ * A pre-built ACK byte pattern with a recorded seq-field position.
+ * Allocate anywhere (stack is fine) but treat the fields as opaque: only
+ * tagotip_ack_template_init()/tagotip_ack_patch_seq() may touch them.
+ */
+typedef struct {
+    uint8_t buf[TAGOTIP_ACK_TEMPLATE_CAP];
+    size_t len;
+    size_t seq_pos;
+    size_t seq_len;
+} TagotipAckTemplate;
+
+/* -----------------------------------------------------------------------
+ * Streaming (SAX-style) uplink parsing
+ * ----------------------------------------------------------------------- */
+
+/**
+ * Owner index passed to on_meta_pair for body-level metadata
+ * (metadata not attached to any variable).
+ */
+#define TAGOTIP_META_OWNER_BODY 0xFFFFu
+
+/** Uplink frame header delivered to on_header. */
+typedef struct {
+    TagotipMethod method;
+    uint8_t has_seq;
+    uint32_t seq;
+    TagotipStr auth;
+    TagotipStr serial;
+} TagotipUplinkHeader;
+
+/**
+ * Callbacks for the streaming uplink parser. Any callback may be NULL to
+ * skip those events. Each callback returns 0 to continue; a non-zero
+ * return aborts the parse and is returned verbatim to the caller.
+ *
+ * All TagotipStr slices borrow from the input buffer and are only valid
+ * for the duration of the callback invocation's enclosing parse call.
+ */
+typedef struct {
+    /** Called once with method, seq, auth, and serial. */
+    int32_t (*on_header)(const TagotipUplinkHeader *header, void *user_data);
+    /** Called per variable in a structured PUSH body, with its index. */
+    int32_t (*on_variable)(uint16_t index, const TagotipVariable *var,
+                           void *user_data);
+    /**
+     * Called per metadata pair with the owning variable's index, or
+     * TAGOTIP_META_OWNER_BODY for body-level metadata.
+     */
+    int32_t (*on_meta_pair)(uint16_t owner_index, const TagotipMetaPair *pair,
+                            void *user_data);
+    /** Called once for a passthrough PUSH body. */
+    int32_t (*on_passthrough)(const TagotipPassthroughBody *body,
+                              void *user_data);
+    /** Called per requested variable name in a PULL body, with its index. */
+    int32_t (*on_pull_variable)(uint16_t index, const TagotipStr *name,
+                                void *user_data);
+} TagotipUplinkVisitor;
+
 /* -----------------------------------------------------------------------
  * Functions
  * ----------------------------------------------------------------------- */
@@ -216,6 +332,83 @@ typedef struct {
 int32_t tagotip_parse_uplink(const uint8_t *input_ptr, size_t input_len,
                              TagotipUplinkFrame *out);
 
+/**
+ * Structurally pre-validate an uplink frame without parsing it.
+ *
+ * Performs only cheap structural checks — the TAGOTIP_MAX_FRAME_SIZE cap,
+ * NUL bytes, the method field, and the pipe-delimited header through the
+ * serial — and writes nothing, so a hot ingestion loop can drop junk input
+ * without zeroing and populating a TagotipUplinkFrame. A frame that fails
+ * here would also fail tagotip_parse_uplink(); a frame that passes may
+ * still be rejected by the full parse.
+ *
+ * @param input_ptr  Pointer to input bytes (UTF-8 not required).
+ * @param input_len  Length of input in bytes.
+ * @return           0 if structurally plausible, negative error code
+ *                   otherwise.
+ */
+int32_t tagotip_validate_uplink(const uint8_t *input_ptr, size_t input_len);
+
+/**
+ * Parse a batch of uplink frames in a single FFI call.
+ *
+ * Each input slice is parsed independently; out_status[i] receives the
+ * same code tagotip_parse_uplink() would return for input i, and
+ * out_frames[i] is only valid where the status is 0. A failed frame does
+ * not stop the batch.
+ *
+ * @param inputs      Array of count input slices (UTF-8).
+ * @param count       Number of frames in the batch.
+ * @param out_frames  Array of count output frame structs (caller-allocated).
+ * @param out_status  Array of count per-frame status codes.
+ * @return            Number of successfully parsed frames.
+ */
+int32_t tagotip_parse_uplink_batch(const TagotipStr *inputs, size_t count,
+                                   TagotipUplinkFrame *out_frames,
+                                   int32_t *out_status);
+
+/**
+ * Parse an uplink frame, delivering events through callbacks instead of
+ * populating a TagotipUplinkFrame. Metadata pairs are emitted through
+ * on_meta_pair (body-level pairs first, then each variable's pairs after
+ * that variable's on_variable event).
+ *
+ * @param input_ptr  Pointer to UTF-8 input bytes.
+ * @param input_len  Length of input in bytes.
+ * @param visitor    Pointer to the callback table.
+ * @param user_data  Opaque pointer passed through to every callback.
+ * @return           0 on success, negative error code on parse failure,
+ *                   or the first non-zero callback return value.
+ */
+int32_t tagotip_parse_uplink_stream(const uint8_t *input_ptr, size_t input_len,
+                                    const TagotipUplinkVisitor *visitor,
+                                    void *user_data);
+
+/**
+ * Initialize an arena over a caller-owned buffer.
+ *
+ * @param arena    Arena to initialize (caller-allocated).
+ * @param buf_ptr  Pointer to the arena's backing buffer; must outlive
+ *                 every string materialized into the arena.
+ * @param buf_len  Size of the backing buffer in bytes.
+ */
+void tagotip_arena_init(TagotipArena *arena, uint8_t *buf_ptr, size_t buf_len);
+
+/**
+ * Materialize a parsed TagotipStr in place, unescaping it if needed.
+ *
+ * A clean slice (needs_unescape zero) is returned untouched — no copy, no
+ * arena space. A dirty slice is decoded into the arena and *s is rewritten
+ * to point at the decoded bytes, which stay valid until the arena is reset
+ * or its buffer is freed. On arena exhaustion the slice and the arena are
+ * left unchanged.
+ *
+ * @param arena  Initialized arena.
+ * @param s      Slice to materialize, as produced by the parse functions.
+ * @return       0 on success, negative error code if the arena is full.
+ */
+int32_t tagotip_unescape_into(TagotipArena *arena, TagotipStr *s);
+
 /**
  * Build an uplink frame into a buffer.
  *
@@ -227,6 +420,145 @@ int32_t tagotip_parse_uplink(const uint8_t *input_ptr, size_t input_len,
 int32_t tagotip_build_uplink(const TagotipUplinkFrame *frame,
                              uint8_t *buf_ptr, size_t buf_len);
 
+/**
+ * Pre-build an ACK frame into a cached byte pattern.
+ *
+ * For bulk downlink generation where every reply is identical except for
+ * the sequence number: build the template once, then stamp out each reply
+ * with tagotip_ack_patch_seq() — a memcpy plus a few digit writes instead
+ * of a full build. The frame must carry a sequence number (has_seq
+ * non-zero); that is the field later patched per reply. The template owns
+ * its bytes (detail text is copied in), so the source frame may be
+ * discarded after init. Unlike tagotip_build_ack(), the detail is fully
+ * serialized.
+ *
+ * @param template  Template to initialize (caller-allocated; treat fields
+ *                  as opaque).
+ * @param frame     Pointer to a populated ACK frame struct.
+ * @return          0 on success, negative error code on failure.
+ */
+int32_t tagotip_ack_template_init(TagotipAckTemplate *template_,
+                                  const TagotipAckFrame *frame);
+
+/**
+ * Emit one ACK from a template, patching in a new sequence number.
+ *
+ * Copies the cached pattern around the recorded seq position and writes
+ * the new digits in between; the patched seq may have a different digit
+ * count than the template's.
+ *
+ * @param template  Initialized template.
+ * @param seq       Sequence number for this reply.
+ * @param out_ptr   Pointer to output buffer.
+ * @param out_len   Size of output buffer in bytes.
+ * @return          Bytes written on success, negative error code on failure.
+ */
+int32_t tagotip_ack_patch_seq(const TagotipAckTemplate *template_,
+                              uint32_t seq,
+                              uint8_t *out_ptr, size_t out_len);
+
+/**
+ * Build an uplink frame as an iovec-style segment list instead of a
+ * contiguous buffer.
+ *
+ * Small generated separators are interleaved with zero-copy references into
+ * the frame's own strings, so the transmit path can hand the segments to
+ * writev() directly and skip one full copy of every outbound frame. Unlike
+ * tagotip_build_uplink(), the push/pull body is fully serialized.
+ *
+ * Segments reference three kinds of storage: the frame's strings, static
+ * library data, and scratch (formatted sequence digits; 10 bytes suffice).
+ * They stay valid until the frame's strings or scratch are modified.
+ *
+ * @param frame         Pointer to a populated frame struct.
+ * @param segments      Array of max_segments output slices.
+ * @param max_segments  Capacity of the segments array.
+ * @param scratch_ptr   Scratch buffer for generated digits.
+ * @param scratch_len   Size of scratch buffer in bytes.
+ * @return              Number of segments emitted on success, negative
+ *                      error code on failure.
+ */
+int32_t tagotip_build_uplink_iovec(const TagotipUplinkFrame *frame,
+                                   TagotipStr *segments, size_t max_segments,
+                                   uint8_t *scratch_ptr, size_t scratch_len);
+
+/**
+ * Build an ACK frame as an iovec-style segment list.
+ *
+ * Same storage and validity rules as tagotip_build_uplink_iovec(); scratch
+ * is used for the sequence number and a count detail (20 bytes suffice).
+ *
+ * @param frame         Pointer to a populated frame struct.
+ * @param segments      Array of max_segments output slices.
+ * @param max_segments  Capacity of the segments array.
+ * @param scratch_ptr   Scratch buffer for generated digits.
+ * @param scratch_len   Size of scratch buffer in bytes.
+ * @return              Number of segments emitted on success, negative
+ *                      error code on failure.
+ */
+int32_t tagotip_build_ack_iovec(const TagotipAckFrame *frame,
+                                TagotipStr *segments, size_t max_segments,
+                                uint8_t *scratch_ptr, size_t scratch_len);
+
+/**
+ * Initialize a builder and write the frame header (METHOD|[!SEQ|]AUTH|SERIAL).
+ *
+ * A PING frame is complete after this call; tagotip_builder_finish() then
+ * returns its length. For PUSH/PULL, follow with tagotip_builder_add_*().
+ *
+ * @param builder  Builder to initialize (caller-allocated).
+ * @param buf_ptr  Output buffer; must outlive the builder.
+ * @param buf_len  Size of output buffer in bytes.
+ * @param method   Frame method.
+ * @param has_seq  Non-zero to include a sequence number.
+ * @param seq      Sequence number (ignored if has_seq is 0).
+ * @param auth     Auth hash string.
+ * @param serial   Device serial string.
+ * @return         0 on success, negative error code on failure.
+ */
+int32_t tagotip_builder_init(TagotipBuilder *builder,
+                             uint8_t *buf_ptr, size_t buf_len,
+                             TagotipMethod method,
+                             uint8_t has_seq, uint32_t seq,
+                             const TagotipStr *auth,
+                             const TagotipStr *serial);
+
+/**
+ * Append a variable to the frame body.
+ *
+ * For PUSH frames the full variable (name, operator, value, unit,
+ * timestamp, group) is serialized; meta_start/meta_len are ignored —
+ * attach metadata with tagotip_builder_add_meta() instead. For PULL
+ * frames only var->name is serialized. Invalid on PING frames.
+ *
+ * @return  0 on success, negative error code on failure.
+ */
+int32_t tagotip_builder_add_variable(TagotipBuilder *builder,
+                                     const TagotipVariable *var);
+
+/**
+ * Append a metadata pair.
+ *
+ * Before the first tagotip_builder_add_variable() call the pair becomes
+ * body-level metadata; afterwards it attaches to the most recently added
+ * variable. Consecutive pairs accumulate into one {...} block. Only valid
+ * on PUSH frames.
+ *
+ * @return  0 on success, negative error code on failure.
+ */
+int32_t tagotip_builder_add_meta(TagotipBuilder *builder,
+                                 const TagotipStr *key,
+                                 const TagotipStr *value);
+
+/**
+ * Finish the frame, closing any open body delimiters.
+ *
+ * The builder must be re-initialized before reuse.
+ *
+ * @return  Total bytes written on success, negative error code on failure.
+ */
+int32_t tagotip_builder_finish(TagotipBuilder *builder);
+
 /**
  * Parse an ACK (downlink) frame.
  *
@@ -194,6 +194,20 @@ fn ffi_parse_uplink_error() {
     assert_eq!(rc, TAGOTIP_ERR_INVALID_METHOD);
 }
 
+#[test]
+fn ffi_validate_uplink() {
+    let good = format!("PUSH|{AUTH}|sensor_01|[temp:=32]");
+    let rc = unsafe { tagotip_validate_uplink(good.as_ptr(), good.len()) };
+    assert_eq!(rc, TAGOTIP_OK);
+
+    let junk = b"GET / HTTP/1.1";
+    let rc = unsafe { tagotip_validate_uplink(junk.as_ptr(), junk.len()) };
+    assert_eq!(rc, TAGOTIP_ERR_INVALID_METHOD);
+
+    let rc = unsafe { tagotip_validate_uplink(good.as_ptr(), 0) };
+    assert_eq!(rc, TAGOTIP_ERR_EMPTY_FRAME);
+}
+
 // =========================================================================
 // 3B. Parse ACK via FFI
 // =========================================================================
@@ -245,3 +259,728 @@ fn ffi_parse_ack_with_seq() {
     assert!(matches!(frame.status, TagotipAckStatus::Ok));
     assert_eq!(frame.detail.count, 5);
 }
+
+// =========================================================================
+// 3C. Streaming parse via FFI
+// =========================================================================
+
+/// Event log collected by the streaming callbacks through `user_data`.
+#[derive(Default)]
+struct StreamLog {
+    header: Option<(u8, String, String)>,
+    variables: Vec<(u16, String)>,
+    meta_pairs: Vec<(u16, String, String)>,
+    passthrough: Option<String>,
+    pull_variables: Vec<String>,
+}
+
+unsafe extern "C" fn log_header(
+    header: *const TagotipUplinkHeader,
+    user_data: *mut std::ffi::c_void,
+) -> i32 {
+    let log = unsafe { &mut *user_data.cast::<StreamLog>() };
+    let header = unsafe { &*header };
+    log.header = Some((
+        header.has_seq,
+        unsafe { str_from_tagotip(&header.auth) }.to_string(),
+        unsafe { str_from_tagotip(&header.serial) }.to_string(),
+    ));
+    0
+}
+
+unsafe extern "C" fn log_variable(
+    index: u16,
+    var: *const TagotipVariable,
+    user_data: *mut std::ffi::c_void,
+) -> i32 {
+    let log = unsafe { &mut *user_data.cast::<StreamLog>() };
+    let var = unsafe { &*var };
+    log.variables
+        .push((index, unsafe { str_from_tagotip(&var.name) }.to_string()));
+    0
+}
+
+unsafe extern "C" fn log_meta_pair(
+    owner_index: u16,
+    pair: *const TagotipMetaPair,
+    user_data: *mut std::ffi::c_void,
+) -> i32 {
+    let log = unsafe { &mut *user_data.cast::<StreamLog>() };
+    let pair = unsafe { &*pair };
+    log.meta_pairs.push((
+        owner_index,
+        unsafe { str_from_tagotip(&pair.key) }.to_string(),
+        unsafe { str_from_tagotip(&pair.value) }.to_string(),
+    ));
+    0
+}
+
+unsafe extern "C" fn log_passthrough(
+    body: *const TagotipPassthroughBody,
+    user_data: *mut std::ffi::c_void,
+) -> i32 {
+    let log = unsafe { &mut *user_data.cast::<StreamLog>() };
+    let body = unsafe { &*body };
+    log.passthrough = Some(unsafe { str_from_tagotip(&body.data) }.to_string());
+    0
+}
+
+unsafe extern "C" fn log_pull_variable(
+    _index: u16,
+    name: *const TagotipStr,
+    user_data: *mut std::ffi::c_void,
+) -> i32 {
+    let log = unsafe { &mut *user_data.cast::<StreamLog>() };
+    log.pull_variables
+        .push(unsafe { str_from_tagotip(&*name) }.to_string());
+    0
+}
+
+unsafe extern "C" fn abort_on_variable(
+    _index: u16,
+    _var: *const TagotipVariable,
+    _user_data: *mut std::ffi::c_void,
+) -> i32 {
+    42
+}
+
+fn full_visitor() -> TagotipUplinkVisitor {
+    TagotipUplinkVisitor {
+        on_header: Some(log_header),
+        on_variable: Some(log_variable),
+        on_meta_pair: Some(log_meta_pair),
+        on_passthrough: Some(log_passthrough),
+        on_pull_variable: Some(log_pull_variable),
+    }
+}
+
+unsafe fn ffi_stream_helper(input: &str, visitor: &TagotipUplinkVisitor) -> (i32, StreamLog) {
+    let mut log = StreamLog::default();
+    let rc = unsafe {
+        tagotip_parse_uplink_stream(
+            input.as_ptr(),
+            input.len(),
+            visitor,
+            (&raw mut log).cast::<std::ffi::c_void>(),
+        )
+    };
+    (rc, log)
+}
+
+#[test]
+fn ffi_stream_structured_push() {
+    let input = format!("PUSH|{AUTH}|sensor_01|[temperature:=32{{src=probe}};humidity:=65]");
+    let (rc, log) = unsafe { ffi_stream_helper(&input, &full_visitor()) };
+    assert_eq!(rc, TAGOTIP_OK);
+    let (has_seq, auth, serial) = log.header.unwrap();
+    assert_eq!(has_seq, 0);
+    assert_eq!(auth, AUTH);
+    assert_eq!(serial, "sensor_01");
+    assert_eq!(
+        log.variables,
+        vec![(0, "temperature".to_string()), (1, "humidity".to_string())]
+    );
+    assert_eq!(
+        log.meta_pairs,
+        vec![(0, "src".to_string(), "probe".to_string())]
+    );
+    assert!(log.passthrough.is_none());
+}
+
+#[test]
+fn ffi_stream_passthrough() {
+    let input = format!("PUSH|{AUTH}|sensor_01|>xDEADBEEF");
+    let (rc, log) = unsafe { ffi_stream_helper(&input, &full_visitor()) };
+    assert_eq!(rc, TAGOTIP_OK);
+    assert!(log.variables.is_empty());
+    assert_eq!(log.passthrough.as_deref(), Some("DEADBEEF"));
+}
+
+#[test]
+fn ffi_stream_pull() {
+    let input = format!("PULL|{AUTH}|sensor_01|[relay_state;setpoint]");
+    let (rc, log) = unsafe { ffi_stream_helper(&input, &full_visitor()) };
+    assert_eq!(rc, TAGOTIP_OK);
+    assert_eq!(log.pull_variables, vec!["relay_state", "setpoint"]);
+}
+
+#[test]
+fn ffi_stream_callback_abort() {
+    let input = format!("PUSH|{AUTH}|sensor_01|[temp:=32;hum:=65]");
+    let visitor = TagotipUplinkVisitor {
+        on_variable: Some(abort_on_variable),
+        ..full_visitor()
+    };
+    let (rc, log) = unsafe { ffi_stream_helper(&input, &visitor) };
+    assert_eq!(rc, 42);
+    assert!(log.header.is_some());
+}
+
+#[test]
+fn ffi_stream_parse_error() {
+    let (rc, log) = unsafe { ffi_stream_helper("INVALID|x|y|[a:=1]", &full_visitor()) };
+    assert_eq!(rc, TAGOTIP_ERR_INVALID_METHOD);
+    assert!(log.header.is_none());
+}
+
+// =========================================================================
+// 3D. Batch parse via FFI
+// =========================================================================
+
+#[test]
+fn ffi_parse_uplink_batch_mixed() {
+    let good = format!("PUSH|{AUTH}|sensor_01|[temp:=32]");
+    let bad = "INVALID|x|y|[a:=1]";
+    let ping = format!("PING|{AUTH}|sensor_02");
+    let inputs = [
+        TagotipStr {
+            ptr: good.as_ptr(),
+            len: good.len(),
+            needs_unescape: 0,
+        },
+        TagotipStr {
+            ptr: bad.as_ptr(),
+            len: bad.len(),
+            needs_unescape: 0,
+        },
+        TagotipStr {
+            ptr: ping.as_ptr(),
+            len: ping.len(),
+            needs_unescape: 0,
+        },
+    ];
+
+    let mut frames: Vec<MaybeUninit<TagotipUplinkFrame>> =
+        (0..3).map(|_| MaybeUninit::zeroed()).collect();
+    let mut status = [0i32; 3];
+
+    let ok = unsafe {
+        tagotip_parse_uplink_batch(
+            inputs.as_ptr(),
+            inputs.len(),
+            frames.as_mut_ptr().cast::<TagotipUplinkFrame>(),
+            status.as_mut_ptr(),
+        )
+    };
+    assert_eq!(ok, 2);
+    assert_eq!(status, [TAGOTIP_OK, TAGOTIP_ERR_INVALID_METHOD, TAGOTIP_OK]);
+
+    let frame = unsafe { frames[0].assume_init_ref() };
+    assert_eq!(unsafe { str_from_tagotip(&frame.serial) }, "sensor_01");
+    let frame = unsafe { frames[2].assume_init_ref() };
+    assert!(matches!(frame.method, TagotipMethod::Ping));
+}
+
+// =========================================================================
+// 3E. iovec build via FFI
+// =========================================================================
+
+/// Helper: iovec-build an uplink frame and join the segments back into one string.
+unsafe fn ffi_uplink_iovec_helper(frame: &TagotipUplinkFrame) -> (i32, String) {
+    let mut segments: Vec<TagotipStr> = (0..256)
+        .map(|_| TagotipStr {
+            ptr: std::ptr::null(),
+            len: 0,
+            needs_unescape: 0,
+        })
+        .collect();
+    let mut scratch = [0u8; 16];
+    let rc = unsafe {
+        tagotip_build_uplink_iovec(
+            frame,
+            segments.as_mut_ptr(),
+            segments.len(),
+            scratch.as_mut_ptr(),
+            scratch.len(),
+        )
+    };
+    let joined = if rc >= 0 {
+        segments[..usize::try_from(rc).unwrap()]
+            .iter()
+            .map(|s| unsafe { str_from_tagotip(s) })
+            .collect()
+    } else {
+        String::new()
+    };
+    (rc, joined)
+}
+
+#[test]
+fn ffi_build_uplink_iovec_round_trip() {
+    let input = format!(
+        "PUSH|!42|{AUTH}|sensor_01|@1700000000^greenhouse{{site=roof}}[temp:=32.5#C;b?=true;pos@=39.74,-104.99,305;s=hello{{src=probe,cal=ok}}]"
+    );
+    let (rc, frame) = unsafe { ffi_parse_uplink_helper(&input) };
+    assert_eq!(rc, TAGOTIP_OK);
+
+    let (n, joined) = unsafe { ffi_uplink_iovec_helper(&frame) };
+    assert!(n > 0, "expected segments, got {n}");
+    assert_eq!(joined, input);
+}
+
+#[test]
+fn ffi_build_uplink_iovec_ping_and_pull() {
+    let ping = format!("PING|{AUTH}|sensor_01");
+    let (rc, frame) = unsafe { ffi_parse_uplink_helper(&ping) };
+    assert_eq!(rc, TAGOTIP_OK);
+    let (n, joined) = unsafe { ffi_uplink_iovec_helper(&frame) };
+    assert!(n > 0);
+    assert_eq!(joined, ping);
+
+    let pull = format!("PULL|{AUTH}|sensor_01|[temperature;humidity]");
+    let (rc, frame) = unsafe { ffi_parse_uplink_helper(&pull) };
+    assert_eq!(rc, TAGOTIP_OK);
+    let (n, joined) = unsafe { ffi_uplink_iovec_helper(&frame) };
+    assert!(n > 0);
+    assert_eq!(joined, pull);
+}
+
+#[test]
+fn ffi_build_uplink_iovec_passthrough() {
+    let input = format!("PUSH|{AUTH}|sensor_01|>xDEADBEEF");
+    let (rc, frame) = unsafe { ffi_parse_uplink_helper(&input) };
+    assert_eq!(rc, TAGOTIP_OK);
+    let (n, joined) = unsafe { ffi_uplink_iovec_helper(&frame) };
+    assert!(n > 0);
+    assert_eq!(joined, input);
+}
+
+#[test]
+fn ffi_build_uplink_iovec_too_many_segments() {
+    let input = format!("PUSH|{AUTH}|sensor_01|[temp:=32;hum:=65]");
+    let (rc, frame) = unsafe { ffi_parse_uplink_helper(&input) };
+    assert_eq!(rc, TAGOTIP_OK);
+
+    let mut segments: [TagotipStr; 4] = std::array::from_fn(|_| TagotipStr {
+        ptr: std::ptr::null(),
+        len: 0,
+        needs_unescape: 0,
+    });
+    let mut scratch = [0u8; 16];
+    let rc = unsafe {
+        tagotip_build_uplink_iovec(
+            &raw const frame,
+            segments.as_mut_ptr(),
+            segments.len(),
+            scratch.as_mut_ptr(),
+            scratch.len(),
+        )
+    };
+    assert_eq!(rc, TAGOTIP_ERR_BUFFER_TOO_SMALL);
+}
+
+#[test]
+fn ffi_build_ack_iovec_round_trip() {
+    for input in [
+        "ACK|!7|OK|5",
+        "ACK|PONG",
+        "ACK|ERR|invalid_token",
+        "ACK|CMD|reboot",
+    ] {
+        let (rc, frame) = unsafe { ffi_parse_ack_helper(input) };
+        assert_eq!(rc, TAGOTIP_OK);
+
+        let mut segments: [TagotipStr; 16] = std::array::from_fn(|_| TagotipStr {
+            ptr: std::ptr::null(),
+            len: 0,
+            needs_unescape: 0,
+        });
+        let mut scratch = [0u8; 32];
+        let rc = unsafe {
+            tagotip_build_ack_iovec(
+                &raw const frame,
+                segments.as_mut_ptr(),
+                segments.len(),
+                scratch.as_mut_ptr(),
+                scratch.len(),
+            )
+        };
+        assert!(rc > 0, "expected segments for {input}, got {rc}");
+        let joined: String = segments[..usize::try_from(rc).unwrap()]
+            .iter()
+            .map(|s| unsafe { str_from_tagotip(s) })
+            .collect();
+        assert_eq!(joined, input);
+    }
+}
+
+// =========================================================================
+// 3F. Incremental builder via FFI
+// =========================================================================
+
+fn tstr(s: &str) -> TagotipStr {
+    TagotipStr {
+        ptr: s.as_ptr(),
+        len: s.len(),
+        needs_unescape: 0,
+    }
+}
+
+fn number_variable(name: &str, value: &str) -> TagotipVariable {
+    TagotipVariable {
+        name: tstr(name),
+        operator: TagotipOperator::Number,
+        value: TagotipValue {
+            tag: TagotipValueTag::Number,
+            str_val: tstr(value),
+            bool_val: 0,
+            lat: TagotipStr {
+                ptr: std::ptr::null(),
+                len: 0,
+                needs_unescape: 0,
+            },
+            lng: TagotipStr {
+                ptr: std::ptr::null(),
+                len: 0,
+                needs_unescape: 0,
+            },
+            alt: TagotipStr {
+                ptr: std::ptr::null(),
+                len: 0,
+                needs_unescape: 0,
+            },
+        },
+        unit: TagotipStr {
+            ptr: std::ptr::null(),
+            len: 0,
+            needs_unescape: 0,
+        },
+        timestamp: TagotipStr {
+            ptr: std::ptr::null(),
+            len: 0,
+            needs_unescape: 0,
+        },
+        group: TagotipStr {
+            ptr: std::ptr::null(),
+            len: 0,
+            needs_unescape: 0,
+        },
+        meta_start: 0,
+        meta_len: 0,
+    }
+}
+
+unsafe fn builder_init_helper(
+    buf: &mut [u8],
+    method: TagotipMethod,
+    has_seq: u8,
+    seq: u32,
+    serial: &str,
+) -> (TagotipBuilder, i32) {
+    let mut builder = MaybeUninit::<TagotipBuilder>::zeroed();
+    let auth = tstr(AUTH);
+    let serial = tstr(serial);
+    let rc = unsafe {
+        tagotip_builder_init(
+            builder.as_mut_ptr(),
+            buf.as_mut_ptr(),
+            buf.len(),
+            method,
+            has_seq,
+            seq,
+            &raw const auth,
+            &raw const serial,
+        )
+    };
+    (unsafe { builder.assume_init() }, rc)
+}
+
+#[test]
+fn ffi_builder_ping() {
+    let mut buf = [0u8; 64];
+    let (mut builder, rc) =
+        unsafe { builder_init_helper(&mut buf, TagotipMethod::Ping, 0, 0, "sensor_01") };
+    assert_eq!(rc, TAGOTIP_OK);
+    let n = unsafe { tagotip_builder_finish(&raw mut builder) };
+    assert!(n > 0);
+    let n = usize::try_from(n).unwrap();
+    let expected = format!("PING|{AUTH}|sensor_01");
+    assert_eq!(&buf[..n], expected.as_bytes());
+}
+
+#[test]
+fn ffi_builder_push_variables_and_meta() {
+    let mut buf = [0u8; 256];
+    let (mut builder, rc) =
+        unsafe { builder_init_helper(&mut buf, TagotipMethod::Push, 1, 7, "sensor_01") };
+    assert_eq!(rc, TAGOTIP_OK);
+
+    let temp = number_variable("temp", "32");
+    let hum = number_variable("hum", "65");
+    let (key, val) = (tstr("src"), tstr("probe"));
+    unsafe {
+        assert_eq!(
+            tagotip_builder_add_variable(&raw mut builder, &raw const temp),
+            TAGOTIP_OK
+        );
+        assert_eq!(
+            tagotip_builder_add_variable(&raw mut builder, &raw const hum),
+            TAGOTIP_OK
+        );
+        assert_eq!(
+            tagotip_builder_add_meta(&raw mut builder, &raw const key, &raw const val),
+            TAGOTIP_OK
+        );
+    }
+    let n = unsafe { tagotip_builder_finish(&raw mut builder) };
+    assert!(n > 0);
+    let n = usize::try_from(n).unwrap();
+    let expected = format!("PUSH|!7|{AUTH}|sensor_01|[temp:=32;hum:=65{{src=probe}}]");
+    assert_eq!(std::str::from_utf8(&buf[..n]).unwrap(), expected);
+
+    // Built frame must round-trip through the parser.
+    let (rc, frame) = unsafe { ffi_parse_uplink_helper(std::str::from_utf8(&buf[..n]).unwrap()) };
+    assert_eq!(rc, TAGOTIP_OK);
+    assert_eq!(frame.seq, 7);
+    assert_eq!(frame.variables_len, 2);
+    assert_eq!(frame.variables[1].meta_len, 1);
+}
+
+#[test]
+fn ffi_builder_body_meta_before_variables() {
+    let mut buf = [0u8; 128];
+    let (mut builder, rc) =
+        unsafe { builder_init_helper(&mut buf, TagotipMethod::Push, 0, 0, "sensor_01") };
+    assert_eq!(rc, TAGOTIP_OK);
+
+    let (key, val) = (tstr("loc"), tstr("roof"));
+    let temp = number_variable("temp", "32");
+    unsafe {
+        assert_eq!(
+            tagotip_builder_add_meta(&raw mut builder, &raw const key, &raw const val),
+            TAGOTIP_OK
+        );
+        assert_eq!(
+            tagotip_builder_add_variable(&raw mut builder, &raw const temp),
+            TAGOTIP_OK
+        );
+    }
+    let n = unsafe { tagotip_builder_finish(&raw mut builder) };
+    assert!(n > 0);
+    let n = usize::try_from(n).unwrap();
+    let expected = format!("PUSH|{AUTH}|sensor_01|{{loc=roof}}[temp:=32]");
+    assert_eq!(std::str::from_utf8(&buf[..n]).unwrap(), expected);
+}
+
+#[test]
+fn ffi_builder_pull() {
+    let mut buf = [0u8; 128];
+    let (mut builder, rc) =
+        unsafe { builder_init_helper(&mut buf, TagotipMethod::Pull, 0, 0, "sensor_01") };
+    assert_eq!(rc, TAGOTIP_OK);
+
+    let relay = number_variable("relay_state", "");
+    let setpoint = number_variable("setpoint", "");
+    unsafe {
+        assert_eq!(
+            tagotip_builder_add_variable(&raw mut builder, &raw const relay),
+            TAGOTIP_OK
+        );
+        assert_eq!(
+            tagotip_builder_add_variable(&raw mut builder, &raw const setpoint),
+            TAGOTIP_OK
+        );
+    }
+    let n = unsafe { tagotip_builder_finish(&raw mut builder) };
+    assert!(n > 0);
+    let n = usize::try_from(n).unwrap();
+    let expected = format!("PULL|{AUTH}|sensor_01|[relay_state;setpoint]");
+    assert_eq!(std::str::from_utf8(&buf[..n]).unwrap(), expected);
+}
+
+#[test]
+fn ffi_builder_buffer_too_small_is_sticky() {
+    let mut buf = [0u8; 8];
+    let (mut builder, rc) =
+        unsafe { builder_init_helper(&mut buf, TagotipMethod::Push, 0, 0, "sensor_01") };
+    assert_eq!(rc, TAGOTIP_ERR_BUFFER_TOO_SMALL);
+
+    let temp = number_variable("temp", "32");
+    unsafe {
+        assert_eq!(
+            tagotip_builder_add_variable(&raw mut builder, &raw const temp),
+            TAGOTIP_ERR_BUFFER_TOO_SMALL
+        );
+        assert_eq!(
+            tagotip_builder_finish(&raw mut builder),
+            TAGOTIP_ERR_BUFFER_TOO_SMALL
+        );
+    }
+}
+
+#[test]
+fn ffi_builder_meta_on_ping_rejected() {
+    let mut buf = [0u8; 64];
+    let (mut builder, rc) =
+        unsafe { builder_init_helper(&mut buf, TagotipMethod::Ping, 0, 0, "sensor_01") };
+    assert_eq!(rc, TAGOTIP_OK);
+
+    let (key, val) = (tstr("k"), tstr("v"));
+    let rc = unsafe { tagotip_builder_add_meta(&raw mut builder, &raw const key, &raw const val) };
+    assert_eq!(rc, TAGOTIP_ERR_INVALID_INPUT);
+}
+
+#[test]
+fn ffi_parse_uplink_batch_empty() {
+    let mut status = [0i32; 1];
+    let mut frame = MaybeUninit::<TagotipUplinkFrame>::zeroed();
+    let ok = unsafe {
+        tagotip_parse_uplink_batch(std::ptr::null(), 0, frame.as_mut_ptr(), status.as_mut_ptr())
+    };
+    assert_eq!(ok, 0);
+}
+
+// =========================================================================
+// 3G. ACK template cache via FFI
+// =========================================================================
+
+unsafe fn ack_template_helper(frame: &TagotipAckFrame) -> (i32, TagotipAckTemplate) {
+    let mut template = MaybeUninit::<TagotipAckTemplate>::zeroed();
+    let rc = unsafe { tagotip_ack_template_init(template.as_mut_ptr(), frame) };
+    (rc, unsafe { template.assume_init() })
+}
+
+unsafe fn patch_seq_helper(template: &TagotipAckTemplate, seq: u32) -> String {
+    let mut out = [0u8; 256];
+    let n = unsafe { tagotip_ack_patch_seq(template, seq, out.as_mut_ptr(), out.len()) };
+    assert!(n > 0, "patch failed with {n}");
+    std::str::from_utf8(&out[..usize::try_from(n).unwrap()])
+        .unwrap()
+        .to_string()
+}
+
+#[test]
+fn ffi_ack_template_patches_seq() {
+    let (rc, frame) = unsafe { ffi_parse_ack_helper("ACK|!1|OK|5") };
+    assert_eq!(rc, TAGOTIP_OK);
+    let (rc, template) = unsafe { ack_template_helper(&frame) };
+    assert_eq!(rc, TAGOTIP_OK);
+
+    // Patched seqs may be narrower or wider than the template's.
+    assert_eq!(unsafe { patch_seq_helper(&template, 7) }, "ACK|!7|OK|5");
+    assert_eq!(unsafe { patch_seq_helper(&template, 42) }, "ACK|!42|OK|5");
+    assert_eq!(
+        unsafe { patch_seq_helper(&template, 4_294_967_295) },
+        "ACK|!4294967295|OK|5"
+    );
+
+    // Every patched frame must re-parse cleanly.
+    let out = unsafe { patch_seq_helper(&template, 1234) };
+    let (rc, reparsed) = unsafe { ffi_parse_ack_helper(&out) };
+    assert_eq!(rc, TAGOTIP_OK);
+    assert_eq!(reparsed.seq, 1234);
+    assert_eq!(reparsed.detail.count, 5);
+}
+
+#[test]
+fn ffi_ack_template_serializes_detail_text() {
+    let (rc, frame) = unsafe { ffi_parse_ack_helper("ACK|!1|ERR|invalid_token") };
+    assert_eq!(rc, TAGOTIP_OK);
+    let (rc, template) = unsafe { ack_template_helper(&frame) };
+    assert_eq!(rc, TAGOTIP_OK);
+    assert_eq!(
+        unsafe { patch_seq_helper(&template, 9) },
+        "ACK|!9|ERR|invalid_token"
+    );
+}
+
+#[test]
+fn ffi_ack_template_requires_seq() {
+    let (rc, frame) = unsafe { ffi_parse_ack_helper("ACK|PONG") };
+    assert_eq!(rc, TAGOTIP_OK);
+    let (rc, _) = unsafe { ack_template_helper(&frame) };
+    assert_eq!(rc, TAGOTIP_ERR_INVALID_INPUT);
+}
+
+#[test]
+fn ffi_ack_patch_seq_buffer_too_small() {
+    let (rc, frame) = unsafe { ffi_parse_ack_helper("ACK|!1|OK|5") };
+    assert_eq!(rc, TAGOTIP_OK);
+    let (rc, template) = unsafe { ack_template_helper(&frame) };
+    assert_eq!(rc, TAGOTIP_OK);
+
+    let mut out = [0u8; 4];
+    let n = unsafe { tagotip_ack_patch_seq(&raw const template, 7, out.as_mut_ptr(), out.len()) };
+    assert_eq!(n, TAGOTIP_ERR_BUFFER_TOO_SMALL);
+}
+
+// =========================================================================
+// 3H. Lazy unescape via FFI
+// =========================================================================
+
+#[test]
+fn ffi_parse_marks_needs_unescape() {
+    let input = format!(r"PUSH|{AUTH}|sensor_01|[msg=door\|open;temp:=32]");
+    let (rc, frame) = unsafe { ffi_parse_uplink_helper(&input) };
+    assert_eq!(rc, TAGOTIP_OK);
+
+    assert_eq!(frame.variables[0].value.str_val.needs_unescape, 1);
+    assert_eq!(frame.variables[1].value.str_val.needs_unescape, 0);
+    assert_eq!(frame.serial.needs_unescape, 0);
+}
+
+#[test]
+fn ffi_unescape_into_clean_is_zero_copy() {
+    let input = format!("PUSH|{AUTH}|sensor_01|[s=hello]");
+    let (rc, mut frame) = unsafe { ffi_parse_uplink_helper(&input) };
+    assert_eq!(rc, TAGOTIP_OK);
+
+    let mut storage = [0u8; 64];
+    let mut arena = MaybeUninit::<TagotipArena>::zeroed();
+    unsafe { tagotip_arena_init(arena.as_mut_ptr(), storage.as_mut_ptr(), storage.len()) };
+    let mut arena = unsafe { arena.assume_init() };
+
+    let s = &mut frame.variables[0].value.str_val;
+    let before = s.ptr;
+    let rc = unsafe { tagotip_unescape_into(&raw mut arena, s) };
+    assert_eq!(rc, TAGOTIP_OK);
+    assert_eq!(s.ptr, before, "clean slice should not be copied");
+    assert_eq!(arena.used, 0);
+}
+
+#[test]
+fn ffi_unescape_into_materializes_dirty() {
+    let input = format!(r"PUSH|{AUTH}|sensor_01|[msg=door\|open{{note=a\,b}}]");
+    let (rc, mut frame) = unsafe { ffi_parse_uplink_helper(&input) };
+    assert_eq!(rc, TAGOTIP_OK);
+
+    let mut storage = [0u8; 64];
+    let mut arena = MaybeUninit::<TagotipArena>::zeroed();
+    unsafe { tagotip_arena_init(arena.as_mut_ptr(), storage.as_mut_ptr(), storage.len()) };
+    let mut arena = unsafe { arena.assume_init() };
+
+    let rc =
+        unsafe { tagotip_unescape_into(&raw mut arena, &raw mut frame.variables[0].value.str_val) };
+    assert_eq!(rc, TAGOTIP_OK);
+    let s = &frame.variables[0].value.str_val;
+    assert_eq!(unsafe { str_from_tagotip(s) }, "door|open");
+    assert_eq!(s.needs_unescape, 0);
+
+    let rc = unsafe { tagotip_unescape_into(&raw mut arena, &raw mut frame.meta_pool[0].value) };
+    assert_eq!(rc, TAGOTIP_OK);
+    assert_eq!(
+        unsafe { str_from_tagotip(&frame.meta_pool[0].value) },
+        "a,b"
+    );
+    assert_eq!(arena.used, "door|open".len() + "a,b".len());
+}
+
+#[test]
+fn ffi_unescape_into_arena_full() {
+    let input = format!(r"PUSH|{AUTH}|sensor_01|[msg=door\|open]");
+    let (rc, mut frame) = unsafe { ffi_parse_uplink_helper(&input) };
+    assert_eq!(rc, TAGOTIP_OK);
+
+    let mut storage = [0u8; 4];
+    let mut arena = MaybeUninit::<TagotipArena>::zeroed();
+    unsafe { tagotip_arena_init(arena.as_mut_ptr(), storage.as_mut_ptr(), storage.len()) };
+    let mut arena = unsafe { arena.assume_init() };
+
+    let s = &mut frame.variables[0].value.str_val;
+    let before = s.ptr;
+    let rc = unsafe { tagotip_unescape_into(&raw mut arena, s) };
+    assert_eq!(rc, TAGOTIP_ERR_BUFFER_TOO_SMALL);
+    assert_eq!(s.ptr, before, "slice must be unchanged on failure");
+    assert_eq!(s.needs_unescape, 1);
+    assert_eq!(arena.used, 0);
+}
@@ -22,6 +22,7 @@ pub fn aead_encrypt(
         CipherSuite::Aes256Ccm => encrypt_aes256_ccm(key, nonce, aad, plaintext),
         CipherSuite::Aes256Gcm => encrypt_aes256_gcm(key, nonce, aad, plaintext),
         CipherSuite::ChaCha20Poly1305 => encrypt_chacha20_poly1305(key, nonce, aad, plaintext),
+        CipherSuite::Aes128Ccm4 => encrypt_aes128_ccm4(key, nonce, aad, plaintext),
     }
 }
 
@@ -46,6 +47,7 @@ pub fn aead_decrypt(
         CipherSuite::ChaCha20Poly1305 => {
             decrypt_chacha20_poly1305(key, nonce, aad, ciphertext_with_tag)
         }
+        CipherSuite::Aes128Ccm4 => decrypt_aes128_ccm4(key, nonce, aad, ciphertext_with_tag),
     }
 }
 
@@ -123,6 +125,80 @@ fn decrypt_aes128_ccm(
     Err(CryptoError::cipher_not_enabled())
 }
 
+// ---------------------------------------------------------------------------
+// AES-128-CCM-4 (truncated 4-byte tag)
+// ---------------------------------------------------------------------------
+
+#[cfg(feature = "aes-128-ccm")]
+fn encrypt_aes128_ccm4(
+    key: &[u8],
+    nonce: &[u8],
+    aad: &[u8],
+    plaintext: &[u8],
+) -> Result<Vec<u8>, CryptoError> {
+    use aes::Aes128;
+    use ccm::Ccm;
+    use ccm::aead::{Aead, KeyInit, Payload};
+    use ccm::consts::{U4, U13};
+
+    type Aes128Ccm4 = Ccm<Aes128, U4, U13>;
+
+    let cipher = Aes128Ccm4::new_from_slice(key).map_err(|_| CryptoError::invalid_key_size())?;
+    let nonce = ccm::aead::generic_array::GenericArray::from_slice(nonce);
+    let payload = Payload {
+        msg: plaintext,
+        aad,
+    };
+    cipher
+        .encrypt(nonce, payload)
+        .map_err(|_| CryptoError::decryption_failed())
+}
+
+#[cfg(not(feature = "aes-128-ccm"))]
+fn encrypt_aes128_ccm4(
+    _key: &[u8],
+    _nonce: &[u8],
+    _aad: &[u8],
+    _plaintext: &[u8],
+) -> Result<Vec<u8>, CryptoError> {
+    Err(CryptoError::cipher_not_enabled())
+}
+
+#[cfg(feature = "aes-128-ccm")]
+fn decrypt_aes128_ccm4(
+    key: &[u8],
+    nonce: &[u8],
+    aad: &[u8],
+    ciphertext_with_tag: &[u8],
+) -> Result<Vec<u8>, CryptoError> {
+    use aes::Aes128;
+    use ccm::Ccm;
+    use ccm::aead::{Aead, KeyInit, Payload};
+    use ccm::consts::{U4, U13};
+
+    type Aes128Ccm4 = Ccm<Aes128, U4, U13>;
+
+    let cipher = Aes128Ccm4::new_from_slice(key).map_err(|_| CryptoError::invalid_key_size())?;
+    let nonce = ccm::aead::generic_array::GenericArray::from_slice(nonce);
+    let payload = Payload {
+        msg: ciphertext_with_tag,
+        aad,
+    };
+    cipher
+        .decrypt(nonce, payload)
+        .map_err(|_| CryptoError::decryption_failed())
+}
+
+#[cfg(not(feature = "aes-128-ccm"))]
+fn decrypt_aes128_ccm4(
+    _key: &[u8],
+    _nonce: &[u8],
+    _aad: &[u8],
+    _ciphertext_with_tag: &[u8],
+) -> Result<Vec<u8>, CryptoError> {
+    Err(CryptoError::cipher_not_enabled())
+}
+
 // ---------------------------------------------------------------------------
 // AES-128-GCM
 // ---------------------------------------------------------------------------
@@ -16,6 +16,9 @@ pub const DEVICE_HASH_SIZE: usize = 8;
 /// CCM authentication tag size (8 bytes).
 pub const CCM_TAG_SIZE: usize = 8;
 
+/// Truncated CCM authentication tag size (4 bytes, suite 5).
+pub const CCM4_TAG_SIZE: usize = 4;
+
 /// GCM / ChaCha20-Poly1305 authentication tag size (16 bytes).
 pub const GCM_TAG_SIZE: usize = 16;
 
@@ -282,4 +282,43 @@ mod tests {
             crate::error::CryptoErrorKind::DecryptionFailed
         );
     }
+
+    /// Suite 5 (AES-128-CCM-4) envelope for the spec inputs, generated by the
+    /// C implementation in tagotip-arduino. Pins both implementations to the
+    /// same bytes.
+    #[cfg(feature = "aes-128-ccm")]
+    const SPEC_ENVELOPE_CCM4: [u8; 45] = [
+        0xa0, 0x00, 0x00, 0x00, 0x2a, 0x4d, 0xee, 0xdd, 0x7b, 0xab, 0x88, 0x17, 0xec, 0xab, 0x77,
+        0x88, 0xd2, 0x2e, 0xb7, 0x37, 0x2f, 0x26, 0x9b, 0x04, 0x1e, 0x89, 0x9c, 0x59, 0xc8, 0x5b,
+        0x12, 0xf5, 0x4d, 0x34, 0x4a, 0xe9, 0x4a, 0xb5, 0x89, 0x01, 0x9a, 0x1b, 0xf5, 0x06, 0xf0,
+    ];
+
+    #[test]
+    #[cfg(feature = "aes-128-ccm")]
+    fn test_ccm4_seal_matches_c_implementation() {
+        let auth_hash = derive_auth_hash("ate2bd319014b24e0a8aca9f00aea4c0d0");
+        let device_hash = crate::hash::derive_device_hash("sensor-01");
+        let key: [u8; 16] = [
+            0xfe, 0x09, 0xda, 0x81, 0xbc, 0x44, 0x00, 0xee, 0x12, 0xab, 0x56, 0xcd, 0x78, 0xef,
+            0x90, 0x12,
+        ];
+
+        let envelope = seal_raw(
+            b"sensor-01|[temp:=32]",
+            EnvelopeMethod::Push,
+            42,
+            auth_hash,
+            device_hash,
+            &key,
+            CipherSuite::Aes128Ccm4,
+        )
+        .unwrap();
+
+        assert_eq!(envelope, SPEC_ENVELOPE_CCM4);
+
+        let (header, method, plaintext) = open_envelope(&envelope, &key).unwrap();
+        assert_eq!(method, EnvelopeMethod::Push);
+        assert_eq!(header.counter, 42);
+        assert_eq!(plaintext, b"sensor-01|[temp:=32]");
+    }
 }
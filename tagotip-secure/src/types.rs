@@ -1,8 +1,8 @@
 use crate::consts::{
-    AES_128_KEY_SIZE, AES_256_KEY_SIZE, AUTH_HASH_SIZE, CCM_NONCE_SIZE, CCM_TAG_SIZE, COUNTER_SIZE,
-    DEVICE_HASH_SIZE, FLAGS_CIPHER_MASK, FLAGS_CIPHER_SHIFT, FLAGS_METHOD_MASK, FLAGS_SIZE,
-    FLAGS_VERSION_MASK, FLAGS_VERSION_SHIFT, GCM_NONCE_SIZE, GCM_TAG_SIZE, HEADER_SIZE,
-    RESERVED_FLAGS_VALUE,
+    AES_128_KEY_SIZE, AES_256_KEY_SIZE, AUTH_HASH_SIZE, CCM_NONCE_SIZE, CCM_TAG_SIZE,
+    CCM4_TAG_SIZE, COUNTER_SIZE, DEVICE_HASH_SIZE, FLAGS_CIPHER_MASK, FLAGS_CIPHER_SHIFT,
+    FLAGS_METHOD_MASK, FLAGS_SIZE, FLAGS_VERSION_MASK, FLAGS_VERSION_SHIFT, GCM_NONCE_SIZE,
+    GCM_TAG_SIZE, HEADER_SIZE, RESERVED_FLAGS_VALUE,
 };
 use crate::error::CryptoError;
 use tagotip_codec::Method;
@@ -20,6 +20,9 @@ pub enum CipherSuite {
     Aes256Gcm = 3,
     /// Suite 4: ChaCha20-Poly1305 (32B key, 16B tag, 12B nonce).
     ChaCha20Poly1305 = 4,
+    /// Suite 5: AES-128-CCM-4 (16B key, 4B truncated tag, 13B nonce) for
+    /// airtime-constrained links.
+    Aes128Ccm4 = 5,
 }
 
 impl CipherSuite {
@@ -31,11 +34,12 @@ impl CipherSuite {
             2 => Ok(Self::Aes256Ccm),
             3 => Ok(Self::Aes256Gcm),
             4 => Ok(Self::ChaCha20Poly1305),
+            5 => Ok(Self::Aes128Ccm4),
             _ => Err(CryptoError::unsupported_cipher()),
         }
     }
 
-    /// Cipher suite ID (0-4).
+    /// Cipher suite ID (0-5).
     #[must_use]
     pub fn id(self) -> u8 {
         self as u8
@@ -45,7 +49,7 @@ impl CipherSuite {
     #[must_use]
     pub fn key_size(self) -> usize {
         match self {
-            Self::Aes128Ccm | Self::Aes128Gcm => AES_128_KEY_SIZE,
+            Self::Aes128Ccm | Self::Aes128Gcm | Self::Aes128Ccm4 => AES_128_KEY_SIZE,
             Self::Aes256Ccm | Self::Aes256Gcm | Self::ChaCha20Poly1305 => AES_256_KEY_SIZE,
         }
     }
@@ -55,6 +59,7 @@ impl CipherSuite {
     pub fn tag_size(self) -> usize {
         match self {
             Self::Aes128Ccm | Self::Aes256Ccm => CCM_TAG_SIZE,
+            Self::Aes128Ccm4 => CCM4_TAG_SIZE,
             Self::Aes128Gcm | Self::Aes256Gcm | Self::ChaCha20Poly1305 => GCM_TAG_SIZE,
         }
     }
@@ -63,7 +68,7 @@ impl CipherSuite {
     #[must_use]
     pub fn nonce_size(self) -> usize {
         match self {
-            Self::Aes128Ccm | Self::Aes256Ccm => CCM_NONCE_SIZE,
+            Self::Aes128Ccm | Self::Aes256Ccm | Self::Aes128Ccm4 => CCM_NONCE_SIZE,
             Self::Aes128Gcm | Self::Aes256Gcm | Self::ChaCha20Poly1305 => GCM_NONCE_SIZE,
         }
     }
@@ -77,6 +82,7 @@ impl CipherSuite {
             Self::Aes256Ccm => cfg!(feature = "aes-256-ccm"),
             Self::Aes256Gcm => cfg!(feature = "aes-256-gcm"),
             Self::ChaCha20Poly1305 => cfg!(feature = "chacha20-poly1305"),
+            Self::Aes128Ccm4 => cfg!(feature = "aes-128-ccm"),
         }
     }
 }
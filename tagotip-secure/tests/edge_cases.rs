@@ -255,9 +255,9 @@ fn test_unsupported_version_decode() {
 
 #[test]
 fn test_unsupported_cipher_decode() {
-    // cipher=5 (bits 7-5 = 101), version=0, method=0
-    // = 0b1010_0000 = 0xA0
-    let result = Flags::decode(0xA0);
+    // cipher=6 (bits 7-5 = 110), version=0, method=0
+    // = 0b1100_0000 = 0xC0
+    let result = Flags::decode(0xC0);
     assert_eq!(result.unwrap_err().kind, CryptoErrorKind::UnsupportedCipher);
 }
 
@@ -298,6 +298,7 @@ fn test_flags_round_trip() {
         (CipherSuite::Aes128Gcm, 1),
         (CipherSuite::Aes256Gcm, 3),
         (CipherSuite::ChaCha20Poly1305, 4),
+        (CipherSuite::Aes128Ccm4, 5),
     ];
     let methods = [
         EnvelopeMethod::Push,
@@ -351,6 +352,10 @@ fn test_cipher_suite_properties() {
     assert_eq!(CipherSuite::ChaCha20Poly1305.key_size(), 32);
     assert_eq!(CipherSuite::ChaCha20Poly1305.tag_size(), 16);
     assert_eq!(CipherSuite::ChaCha20Poly1305.nonce_size(), 12);
+
+    assert_eq!(CipherSuite::Aes128Ccm4.key_size(), 16);
+    assert_eq!(CipherSuite::Aes128Ccm4.tag_size(), 4);
+    assert_eq!(CipherSuite::Aes128Ccm4.nonce_size(), 13);
 }
 
 #[test]
@@ -363,7 +368,8 @@ fn test_cipher_suite_from_id() {
         CipherSuite::from_id(4).unwrap(),
         CipherSuite::ChaCha20Poly1305
     );
-    assert!(CipherSuite::from_id(5).is_err());
+    assert_eq!(CipherSuite::from_id(5).unwrap(), CipherSuite::Aes128Ccm4);
+    assert!(CipherSuite::from_id(6).is_err());
     assert!(CipherSuite::from_id(7).is_err());
 }
 